@@ -14,6 +14,7 @@
  */
 
 #include <err.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
@@ -63,7 +64,7 @@ int uart0_puts(char *astring, int length)
 void _native_handle_uart0_input()
 {
     char buf[42];
-    int nread;
+    int nread, space;
 
     if (!FD_ISSET(_native_uart_in, &_native_rfds)) {
         DEBUG("_native_handle_uart0_input - nothing to do\n");
@@ -71,15 +72,25 @@ void _native_handle_uart0_input()
     }
     DEBUG("_native_handle_uart0_input\n");
 
-    nread = read(_native_uart_in, buf, sizeof(buf));
+    /* never read more than the ringbuffer takes, a script would lose
+     * everything beyond it */
+    space = uart0_rx_free();
+    nread = read(_native_uart_in, buf, (space < (int) sizeof(buf)) ? space : (int) sizeof(buf));
     if (nread == -1) {
         err(1, "_native_handle_uart0_input(): read()");
     }
     else if (nread == 0) {
+        close(_native_uart_in);
+
+        if (_native_uart_in != STDIN_FILENO) {
+            /* end of the script, go on with stdin */
+            _native_uart_in = STDIN_FILENO;
+            return;
+        }
+
         /* XXX:
          * preliminary resolution for this situation, will be coped
          * with properly in #161 */
-        close(_native_uart_in);
         _native_uart_in = -1;
         printf("stdin closed");
     }
@@ -94,7 +105,8 @@ void _native_handle_uart0_input()
 int _native_set_uart_fds(void)
 {
     DEBUG("_native_set_uart_fds");
-    if (_native_uart_in != -1) {
+    /* leave input waiting while the ringbuffer is full */
+    if ((_native_uart_in != -1) && (uart0_rx_free() > 0)) {
         FD_SET(_native_uart_in, &_native_rfds);
     }
     return _native_uart_in;
@@ -104,5 +116,13 @@ void _native_init_uart0()
 {
     _native_uart_in = STDIN_FILENO;
 
+    if (_native_uart0_script != NULL) {
+        _native_uart_in = open(_native_uart0_script, O_RDONLY);
+
+        if (_native_uart_in == -1) {
+            err(EXIT_FAILURE, "_native_init_uart0: open(%s)", _native_uart0_script);
+        }
+    }
+
     puts("RIOT native uart0 initialized.");
 }
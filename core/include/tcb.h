@@ -34,6 +34,7 @@
 #define STATUS_SEND_BLOCKED 	(0x0080)
 #define STATUS_REPLY_BLOCKED 	(0x0100)
 #define STATUS_TIMER_WAITING	(0x0200)
+#define STATUS_POLL_BLOCKED		(0x0400)
 
 typedef struct tcb_t {
     char *sp;
@@ -57,7 +57,14 @@ const char *thread_getname(int pid);
 void thread_sleep(void);
 
 /**
- * @brief   Wakes up a sleeping thread.
+ * @brief   Like thread_sleep(), but a message sent to the thread wakes it up
+ *          as well. The message is queued or its sender blocked as usual,
+ *          the thread still has to msg_receive() it.
+ */
+void thread_poll_sleep(void);
+
+/**
+ * @brief   Wakes up a sleeping thread, also one in thread_poll_sleep().
  * @param   pid The PID of the thread to be woken up
  * @return  STATUS_NOT_FOUND if pid is unknown or not sleeping
  */
@@ -68,8 +68,21 @@ int msg_send(msg_t *m, unsigned int target_pid, bool block)
     dINT();
 
     if (target->status != STATUS_RECEIVE_BLOCKED) {
+        int poll_woken = 0;
+
+        if (target->status == STATUS_POLL_BLOCKED) {
+            sched_set_status(target, STATUS_PENDING);
+            poll_woken = 1;
+        }
+
         if (target->msg_array && queue_msg(target, m)) {
             eINT();
+
+            /* a woken poller of higher priority runs at once */
+            if (poll_woken) {
+                sched_switch(active_thread->priority, target->priority, 0);
+            }
+
             return 1;
         }
 
@@ -136,6 +149,12 @@ int msg_send_int(msg_t *m, unsigned int target_pid)
     }
     else {
         DEBUG("msg_send_int: Receiver not waiting.\n");
+
+        if (target->status == STATUS_POLL_BLOCKED) {
+            sched_set_status(target, STATUS_PENDING);
+            sched_context_switch_request = 1;
+        }
+
         return (queue_msg(target, m));
     }
 }
@@ -68,6 +68,18 @@ void thread_sleep()
     thread_yield();
 }
 
+void thread_poll_sleep()
+{
+    if (inISR()) {
+        return;
+    }
+
+    dINT();
+    sched_set_status((tcb_t *)active_thread, STATUS_POLL_BLOCKED);
+    eINT();
+    thread_yield();
+}
+
 int thread_wakeup(int pid)
 {
     DEBUG("thread_wakeup: Trying to wakeup PID %i...\n", pid);
@@ -80,7 +92,7 @@ int thread_wakeup(int pid)
 
     int result = sched_threads[pid]->status;
 
-    if (result == STATUS_SLEEPING) {
+    if ((result == STATUS_SLEEPING) || (result == STATUS_POLL_BLOCKED)) {
         DEBUG("thread_wakeup: Thread is sleeping.\n");
         sched_set_status((tcb_t *)sched_threads[pid], STATUS_RUNNING);
 
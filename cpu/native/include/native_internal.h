@@ -52,6 +52,9 @@ extern ucontext_t *_native_cur_ctx, *_native_isr_ctx;
 #ifdef MODULE_UART0
 #include <sys/select.h>
 extern fd_set _native_rfds;
+
+/** file fed to uart0 before stdin, set with -s on the command line */
+extern const char *_native_uart0_script;
 #endif
 
 /** @} */
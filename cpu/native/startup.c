@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <err.h>
 
 
@@ -32,15 +33,41 @@
 #include "native_internal.h"
 #include "tap.h"
 
+#ifdef MODULE_UART0
+const char *_native_uart0_script = NULL;
+
+/* removes "-s <file>" from argv, so the positional arguments stay in place */
+static int parse_script_arg(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0) {
+            if (i + 1 >= argc) {
+                errx(EXIT_FAILURE, "-s: missing script file");
+            }
+
+            _native_uart0_script = argv[i + 1];
+            memmove(&argv[i], &argv[i + 2], (argc - i - 1) * sizeof(char *));
+            return argc - 2;
+        }
+    }
+
+    return argc;
+}
+#endif
+
 __attribute__((constructor)) static void startup(int argc, char **argv)
 {
     /* get system read/write */
     *(void **)(&real_read) = dlsym(RTLD_NEXT, "read");
     *(void **)(&real_write) = dlsym(RTLD_NEXT, "write");
 
+#ifdef MODULE_UART0
+    argc = parse_script_arg(argc, argv);
+#endif
+
 #ifdef MODULE_NATIVENET
     if (argc < 2) {
-        printf("usage: %s <tap interface>\n", argv[0]);
+        printf("usage: %s [-s <script>] <tap interface>\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 #else /* args unused here */
@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2013 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser General
+# Public License. See the file LICENSE in the top level directory for more
+# details.
+#
+# Decodes the binary frames written by the binlog module in binary mode.
+# Everything else in the stream is passed through unchanged.
+#
+# usage: binlog.py [-t] <elf file> [<log file>]
+#
+#   -t  prefix every record with its hwtimer timestamp, module and level
+#
+# Without a log file, the stream is read from stdin, e.g.
+#   ./bin/native/app.elf | binlog.py -t bin/native/app.elf
+
+import re
+import struct
+import sys
+
+MAGIC = b'\xb1\x06'
+LEVELS = ['none', 'error', 'warning', 'info', 'debug']
+CONVERSION = re.compile(r'%([-+ #0-9.]*)[hlzjt]*([diuxXocsp%])')
+
+
+class Elf(object):
+    """The allocated sections of an ELF file, to read strings by address."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+
+        if data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+
+        is64 = bytearray(data)[4] == 2
+        self.endian = '<' if bytearray(data)[5] == 1 else '>'
+        e = self.endian
+
+        if is64:
+            shoff, = struct.unpack_from(e + 'Q', data, 0x28)
+            shentsize, shnum = struct.unpack_from(e + 'HH', data, 0x3a)
+        else:
+            shoff, = struct.unpack_from(e + 'I', data, 0x20)
+            shentsize, shnum = struct.unpack_from(e + 'HH', data, 0x2e)
+
+        self.sections = []
+
+        for i in range(shnum):
+            base = shoff + i * shentsize
+
+            if is64:
+                stype, flags, addr, offset, size = \
+                    struct.unpack_from(e + 'IQQQQ', data, base + 4)
+            else:
+                stype, flags, addr, offset, size = \
+                    struct.unpack_from(e + 'IIIII', data, base + 4)
+
+            # SHF_ALLOC, not SHT_NOBITS
+            if (flags & 0x2) and stype != 8 and addr:
+                self.sections.append((addr, size, data[offset:offset + size]))
+
+    def string(self, addr):
+        for start, size, content in self.sections:
+            if start <= addr < start + size:
+                end = content.find(b'\0', addr - start)
+                if end < 0:
+                    end = size
+                return content[addr - start:end].decode('utf-8', 'replace')
+
+        return None
+
+
+def format_record(elf, fmt, args):
+    args = list(args)
+
+    def convert(match):
+        flags, conv = match.groups()
+
+        if conv == '%':
+            return '%'
+
+        arg = args.pop(0) if args else 0
+
+        if conv in 'di':
+            if arg & 0x80000000:
+                arg -= 1 << 32
+            return ('%' + flags + 'd') % arg
+        if conv == 'u':
+            return ('%' + flags + 'd') % arg
+        if conv in 'xXo':
+            return ('%' + flags + conv) % arg
+        if conv == 'c':
+            return ('%' + flags + 'c') % chr(arg & 0xff)
+        if conv == 's':
+            s = elf.string(arg)
+            return ('%' + flags + 's') % (s if s is not None else '<0x%x>' % arg)
+        return '0x%x' % arg
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(elf, stream, out, timestamps):
+    buf = b''
+
+    while True:
+        chunk = stream.read(1024)
+
+        if not chunk:
+            out.write(buf)
+            return
+
+        buf += chunk
+
+        while True:
+            pos = buf.find(MAGIC)
+
+            if pos < 0:
+                # keep a possible first magic byte for the next chunk
+                keep = 1 if buf.endswith(MAGIC[:1]) else 0
+                out.write(buf[:len(buf) - keep])
+                buf = buf[len(buf) - keep:]
+                break
+
+            out.write(buf[:pos])
+            buf = buf[pos:]
+
+            if len(buf) < 14:
+                break
+
+            header, ticks, fmt = struct.unpack_from(elf.endian + 'III', buf, 2)
+            nargs = header & 0xff
+            size = 14 + 4 * nargs
+
+            if len(buf) < size:
+                break
+
+            args = struct.unpack_from(elf.endian + '%dI' % nargs, buf, 14)
+            buf = buf[size:]
+
+            text = elf.string(fmt)
+
+            if text is None:
+                text = '<unknown format 0x%x>\n' % fmt
+            else:
+                text = format_record(elf, text, args)
+
+            if timestamps:
+                level = (header >> 8) & 0xff
+                text = '[%10u] %u %s: %s' % (ticks, (header >> 16) & 0xff,
+                                             LEVELS[level] if level < len(LEVELS) else level,
+                                             text)
+
+            out.write(text.encode('utf-8'))
+
+        out.flush()
+
+
+def main(argv):
+    timestamps = False
+
+    if len(argv) > 1 and argv[1] == '-t':
+        timestamps = True
+        argv = argv[1:]
+
+    if len(argv) not in (2, 3):
+        sys.stderr.write('usage: %s [-t] <elf file> [<log file>]\n' % sys.argv[0])
+        return 1
+
+    elf = Elf(argv[1])
+    stdin = getattr(sys.stdin, 'buffer', sys.stdin)
+    stdout = getattr(sys.stdout, 'buffer', sys.stdout)
+
+    if len(argv) == 3:
+        with open(argv[2], 'rb') as stream:
+            decode(elf, stream, stdout, timestamps)
+    else:
+        decode(elf, stdin, stdout, timestamps)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -35,6 +35,10 @@
 #include "rtc.h"
 #endif
 
+#ifdef MODULE_BINLOG
+#include "binlog.h"
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -64,6 +68,10 @@ void auto_init(void)
     DEBUG("Auto init uart0 module.\n");
     board_uart0_init();
 #endif
+#ifdef MODULE_BINLOG
+    DEBUG("Auto init binlog module.\n");
+    binlog_init();
+#endif
 #ifdef MODULE_RTC
     DEBUG("Auto init rtc module.\n");
     rtc_init();
@@ -0,0 +1,269 @@
+/**
+ * Deferred binary logging
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup binlog
+ * @{
+ * @file    binlog.c
+ * @author  Freie Universität Berlin, Computer Systems & Telematics
+ * @}
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu-conf.h"
+#include "hwtimer.h"
+#include "irq.h"
+#include "kernel.h"
+#include "sched.h"
+#include "tcb.h"
+#include "thread.h"
+
+#include "binlog.h"
+
+#ifndef BINLOG_STACKSIZE
+#define BINLOG_STACKSIZE    (KERNEL_CONF_STACKSIZE_PRINTF)
+#endif
+
+#define RING_MASK           (BINLOG_RING_WORDS - 1)
+#define HEADER_WORDS        (3)     /* header, timestamp, format */
+
+/*
+ * A record is
+ *   header:    module << 16 | level << 8 | number of arguments
+ *   timestamp: hwtimer_now()
+ *   format:    address of the format string
+ *   arguments
+ * one word each, it may wrap around the end of the ring.
+ */
+static uint32_t ring[BINLOG_RING_WORDS];
+static unsigned int head;       /* free running, only masked for access */
+static unsigned int tail;
+static uint32_t dropped;
+static uint32_t dropped_reported;
+static int binary;
+
+static int binlog_pid = -1;
+static int binlog_sleeping;
+static char binlog_stack[BINLOG_STACKSIZE];
+
+static const char dropped_fmt[] = "binlog: %lu records dropped\n";
+
+uint8_t binlog_level[BINLOG_MODULES];
+
+void binlog_write(unsigned int module, unsigned int level, const char *fmt,
+                  unsigned int nargs, const uint32_t *args)
+{
+    uint32_t now = hwtimer_now();
+    unsigned state = disableIRQ();
+    unsigned int h = head;
+
+    if (nargs > BINLOG_MAX_ARGS) {
+        nargs = BINLOG_MAX_ARGS;
+    }
+
+    /* the whole record is copied with interrupts off, it is at most nine
+     * words and the ring needs no lock this way, even against ISRs */
+    if (BINLOG_RING_WORDS - (h - tail) < HEADER_WORDS + nargs) {
+        dropped++;
+        restoreIRQ(state);
+        return;
+    }
+
+    ring[h++ & RING_MASK] = ((uint32_t) module << 16) | (level << 8) | nargs;
+    ring[h++ & RING_MASK] = now;
+    ring[h++ & RING_MASK] = (uint32_t)(uintptr_t) fmt;
+
+    for (unsigned int i = 0; i < nargs; i++) {
+        ring[h++ & RING_MASK] = args[i];
+    }
+
+    head = h;
+
+    /* no thread_wakeup(), it would enable interrupts and yield; the thread
+     * has the lowest priority and runs once everybody else waits anyway */
+    if (binlog_sleeping) {
+        binlog_sleeping = 0;
+        sched_set_status((tcb_t *) sched_threads[binlog_pid], STATUS_RUNNING);
+    }
+
+    restoreIRQ(state);
+}
+
+void binlog_set_level(unsigned int module, unsigned int level)
+{
+    if (module < BINLOG_MODULES) {
+        binlog_level[module] = level;
+    }
+}
+
+void binlog_set_binary(int on)
+{
+    binary = on;
+}
+
+uint32_t binlog_dropped(void)
+{
+    return dropped;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* prints one conversion of fmt with the argument converted to the type it
+ * expects, returns the rest of fmt */
+static const char *print_conversion(const char *fmt, uint32_t arg)
+{
+    char spec[16];
+    size_t n = 1 + strspn(fmt + 1, "-+ #0123456789.");
+    const char *conv = fmt + n;
+
+    conv += strspn(conv, "hlzjt");
+
+    if ((*conv == '\0') || (n > sizeof(spec) - 3)) {
+        fputs(fmt, stdout);
+        return fmt + strlen(fmt);
+    }
+
+    memcpy(spec, fmt, n);
+
+    switch (*conv) {
+        case 'd':
+        case 'i':
+            memcpy(spec + n, "ld", 3);
+            printf(spec, (long)(int32_t) arg);
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec[n] = 'l';
+            spec[n + 1] = *conv;
+            spec[n + 2] = '\0';
+            printf(spec, (unsigned long) arg);
+            break;
+
+        case 'c':
+            memcpy(spec + n, "c", 2);
+            printf(spec, (int) arg);
+            break;
+
+        case 's':
+            memcpy(spec + n, "s", 2);
+            printf(spec, (const char *)(uintptr_t) arg);
+            break;
+
+        case 'p':
+            memcpy(spec + n, "p", 2);
+            printf(spec, (void *)(uintptr_t) arg);
+            break;
+
+        default:
+            fwrite(fmt, 1, conv + 1 - fmt, stdout);
+    }
+
+    return conv + 1;
+}
+
+static void print_record(const char *fmt, const uint32_t *args,
+                         unsigned int nargs)
+{
+    unsigned int a = 0;
+
+    while (*fmt) {
+        if (*fmt != '%') {
+            size_t n = strcspn(fmt, "%");
+            fwrite(fmt, 1, n, stdout);
+            fmt += n;
+        }
+        else if (fmt[1] == '%') {
+            putchar('%');
+            fmt += 2;
+        }
+        else {
+            fmt = print_conversion(fmt, (a < nargs) ? args[a] : 0);
+            a++;
+        }
+    }
+}
+
+static void write_frame(const uint32_t *record, unsigned int words)
+{
+    const char *p = (const char *) record;
+
+    putchar(BINLOG_FRAME_MAGIC0);
+    putchar(BINLOG_FRAME_MAGIC1);
+
+    for (unsigned int i = 0; i < words * sizeof(uint32_t); i++) {
+        putchar(p[i]);
+    }
+}
+
+static void output(const uint32_t *record)
+{
+    unsigned int nargs = record[0] & 0xff;
+
+    if (binary) {
+        write_frame(record, HEADER_WORDS + nargs);
+    }
+    else {
+        print_record((const char *)(uintptr_t) record[2],
+                     record + HEADER_WORDS, nargs);
+    }
+}
+
+static void binlog_thread(void)
+{
+    uint32_t record[HEADER_WORDS + BINLOG_MAX_ARGS];
+
+    while (1) {
+        unsigned state = disableIRQ();
+        unsigned int t = tail;
+        uint32_t lost = dropped - dropped_reported;
+
+        if (t == head) {
+            binlog_sleeping = 1;
+            thread_sleep();
+            restoreIRQ(state);
+            continue;
+        }
+
+        unsigned int words = HEADER_WORDS + (ring[t & RING_MASK] & 0xff);
+
+        for (unsigned int i = 0; i < words; i++) {
+            record[i] = ring[t++ & RING_MASK];
+        }
+
+        tail = t;
+        dropped_reported += lost;
+        restoreIRQ(state);
+
+        if (lost) {
+            uint32_t report[HEADER_WORDS + 1] = {
+                ((uint32_t) BINLOG_MOD_DEFAULT << 16) | (BINLOG_WARNING << 8) | 1,
+                hwtimer_now(),
+                (uint32_t)(uintptr_t) dropped_fmt,
+                lost
+            };
+
+            output(report);
+        }
+
+        output(record);
+    }
+}
+
+void binlog_init(void)
+{
+    memset(binlog_level, BINLOG_INFO, sizeof(binlog_level));
+    binlog_pid = thread_create(binlog_stack, sizeof(binlog_stack),
+                               PRIORITY_IDLE - 1, CREATE_STACKTEST,
+                               binlog_thread, "binlog");
+}
@@ -17,6 +17,7 @@
 #include <limits.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "bloom.h"
 
@@ -67,6 +68,16 @@ struct bloom_t *bloom_new(size_t size, size_t num_hashes, ...)
     return bloom;
 }
 
+void bloom_init(struct bloom_t *bloom, size_t size, uint8_t *bitfield,
+                hashfp_t *hashes, size_t num_hashes)
+{
+    memset(bitfield, 0, ROUND(size));
+    bloom->a = bitfield;
+    bloom->hash = hashes;
+    bloom->k = num_hashes;
+    bloom->m = size;
+}
+
 void bloom_del(struct bloom_t *bloom)
 {
     free(bloom->a);
@@ -0,0 +1,227 @@
+/**
+ * Blocked and counting Bloom filter implementation
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @file
+ * @autor Freie Universität Berlin, Computer Systems & Telematics
+ *
+ */
+
+#include <string.h>
+
+#include "bloom_blocked.h"
+
+#define BLOCK_BITS      (BLOOM_BLOCK_SIZE * 8)
+#define BLOCK_NIBBLES   (BLOOM_BLOCK_SIZE * 2)
+#define MAX_HASHES      (16)
+
+/*
+ * The upper half of the hash selects the block (multiply-shift, so any
+ * number of blocks works), its low bits and the lower half give the two
+ * hashes for the positions inside the block. h2 is made odd, so the k
+ * positions are distinct.
+ */
+struct bloom_pos {
+    bloom_block_t *block;
+    uint32_t h1, h2;
+};
+
+static void bloom_locate(struct bloom_pos *p, bloom_block_t *blocks,
+                         size_t nblocks, const uint8_t *buf, size_t len)
+{
+    uint64_t h = bloom_hash64(buf, len);
+    uint32_t hi = (uint32_t)(h >> 32);
+
+    p->block = blocks + (size_t)(((uint64_t) hi * nblocks) >> 32);
+    p->h1 = (uint32_t) h;
+    p->h2 = hi | 1;
+}
+
+/* MurmurHash64A by Austin Appleby, public domain */
+uint64_t bloom_hash64(const uint8_t *buf, size_t len)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t h = len * m;
+    uint64_t k;
+
+    while (len >= 8) {
+        memcpy(&k, buf, 8);     /* buf may be unaligned */
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+        buf += 8;
+        len -= 8;
+    }
+
+    switch (len) {
+        case 7:
+            h ^= (uint64_t) buf[6] << 48;
+            /* fall through */
+        case 6:
+            h ^= (uint64_t) buf[5] << 40;
+            /* fall through */
+        case 5:
+            h ^= (uint64_t) buf[4] << 32;
+            /* fall through */
+        case 4:
+            h ^= (uint64_t) buf[3] << 24;
+            /* fall through */
+        case 3:
+            h ^= (uint64_t) buf[2] << 16;
+            /* fall through */
+        case 2:
+            h ^= (uint64_t) buf[1] << 8;
+            /* fall through */
+        case 1:
+            h ^= (uint64_t) buf[0];
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void bloom_blocked_init(struct bloom_blocked_t *bloom, bloom_block_t *blocks,
+                        size_t nblocks, size_t num_hashes)
+{
+    memset(blocks, 0, nblocks * sizeof(bloom_block_t));
+    bloom->blocks = blocks;
+    bloom->nblocks = nblocks;
+    bloom->k = num_hashes > MAX_HASHES ? MAX_HASHES : num_hashes;
+}
+
+void bloom_blocked_add(struct bloom_blocked_t *bloom, const uint8_t *buf,
+                       size_t len)
+{
+    struct bloom_pos p;
+    uint32_t g;
+    size_t n;
+
+    bloom_locate(&p, bloom->blocks, bloom->nblocks, buf, len);
+
+    for (n = 0, g = p.h1; n < bloom->k; n++, g += p.h2) {
+        uint32_t bit = g % BLOCK_BITS;
+
+        p.block->w[bit / 32] |= (uint32_t) 1 << (bit % 32);
+    }
+}
+
+bool bloom_blocked_check(struct bloom_blocked_t *bloom, const uint8_t *buf,
+                         size_t len)
+{
+    struct bloom_pos p;
+    uint32_t g;
+    size_t n;
+
+    bloom_locate(&p, bloom->blocks, bloom->nblocks, buf, len);
+
+    for (n = 0, g = p.h1; n < bloom->k; n++, g += p.h2) {
+        uint32_t bit = g % BLOCK_BITS;
+
+        if (!(p.block->w[bit / 32] & ((uint32_t) 1 << (bit % 32)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+
+#define NIBBLE(b, i)    (((b)->w[(i) / 8] >> (((i) % 8) * 4)) & 0xf)
+#define NIBBLE_ONE(i)   ((uint32_t) 1 << (((i) % 8) * 4))
+
+void bloom_counting_init(struct bloom_counting_t *bloom, bloom_block_t *blocks,
+                         size_t nblocks, size_t num_hashes)
+{
+    memset(blocks, 0, nblocks * sizeof(bloom_block_t));
+    bloom->blocks = blocks;
+    bloom->nblocks = nblocks;
+    bloom->k = num_hashes > MAX_HASHES ? MAX_HASHES : num_hashes;
+}
+
+void bloom_counting_add(struct bloom_counting_t *bloom, const uint8_t *buf,
+                        size_t len)
+{
+    struct bloom_pos p;
+    uint32_t g;
+    size_t n;
+
+    bloom_locate(&p, bloom->blocks, bloom->nblocks, buf, len);
+
+    for (n = 0, g = p.h1; n < bloom->k; n++, g += p.h2) {
+        uint32_t i = g % BLOCK_NIBBLES;
+
+        if (NIBBLE(p.block, i) != 0xf) {
+            p.block->w[i / 8] += NIBBLE_ONE(i);
+        }
+    }
+}
+
+void bloom_counting_remove(struct bloom_counting_t *bloom, const uint8_t *buf,
+                           size_t len)
+{
+    struct bloom_pos p;
+    uint32_t g;
+    size_t n;
+
+    bloom_locate(&p, bloom->blocks, bloom->nblocks, buf, len);
+
+    for (n = 0, g = p.h1; n < bloom->k; n++, g += p.h2) {
+        uint32_t i = g % BLOCK_NIBBLES;
+        uint32_t c = NIBBLE(p.block, i);
+
+        /* a saturated counter has lost count */
+        if (c != 0 && c != 0xf) {
+            p.block->w[i / 8] -= NIBBLE_ONE(i);
+        }
+    }
+}
+
+bool bloom_counting_check(struct bloom_counting_t *bloom, const uint8_t *buf,
+                          size_t len)
+{
+    struct bloom_pos p;
+    uint32_t g;
+    size_t n;
+
+    bloom_locate(&p, bloom->blocks, bloom->nblocks, buf, len);
+
+    for (n = 0, g = p.h1; n < bloom->k; n++, g += p.h2) {
+        if (!NIBBLE(p.block, g % BLOCK_NIBBLES)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void bloom_counting_decay(struct bloom_counting_t *bloom)
+{
+    size_t b;
+    int i;
+
+    for (b = 0; b < bloom->nblocks; b++) {
+        uint32_t *w = bloom->blocks[b].w;
+
+        for (i = 0; i < BLOOM_BLOCK_WORDS; i++) {
+            /* the lowest bit of every nibble which is not zero */
+            uint32_t nz = (w[i] | w[i] >> 1 | w[i] >> 2 | w[i] >> 3)
+                          & 0x11111111;
+
+            w[i] -= nz;
+        }
+    }
+}
@@ -19,28 +19,17 @@
 #include <errno.h>
 
 #include "kernel.h"
-#include "irq.h"
 
 #include "thread.h"
 #include "msg.h"
 
-#include "ringbuffer.h"
+#include "tsrb.h"
 #include "posix_io.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
-static int min(int a, int b)
-{
-    if (b > a) {
-        return a;
-    }
-    else {
-        return b;
-    }
-}
-
-void chardev_loop(ringbuffer_t *rb)
+void chardev_loop(tsrb_t *rb)
 {
     msg_t m;
 
@@ -103,11 +92,10 @@ void chardev_loop(ringbuffer_t *rb)
             }
         }
 
-        if (rb->avail && (r != NULL)) {
-            int state = disableIRQ();
-            int nbytes = min(r->nbytes, rb->avail);
+        if (tsrb_avail(rb) && (r != NULL)) {
+            /* the ISR may add more meanwhile, that is fine for a tsrb */
+            int nbytes = tsrb_get(rb, r->buffer, r->nbytes);
             DEBUG("uart0_thread [%i]: sending %i bytes received from %i to pid %i\n", pid, nbytes, m.sender_pid, reader_pid);
-            rb_get_elements(rb, r->buffer, nbytes);
             r->nbytes = nbytes;
 
             m.sender_pid = reader_pid;
@@ -117,7 +105,6 @@ void chardev_loop(ringbuffer_t *rb)
             msg_reply(&m, &m);
 
             r = NULL;
-            restoreIRQ(state);
         }
     }
 }
@@ -31,35 +31,22 @@
 
 #include "sha256.h"
 
-#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-/* Copy a vector of big-endian uint32_t into a vector of bytes */
-#define be32enc_vect memcpy
-
-/* Copy a vector of bytes into a vector of big-endian uint32_t */
-#define be32dec_vect memcpy
-
-#else /* __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__ */
-
-/*
- * Encode a length len/4 vector of (uint32_t) into a length len vector of
- * (unsigned char) in big-endian form.  Assumes len is a multiple of 4.
- */
-static void be32enc_vect(void *dst_, const void *src_, size_t len)
+/* Big-endian loads and stores which work at any alignment. GCC turns
+ * them into a plain load/store (plus a byte swap on little-endian hosts)
+ * where the CPU allows unaligned access. */
+static inline uint32_t be32dec(const unsigned char *p)
 {
-    uint32_t *dst = dst_;
-    const uint32_t *src = src_;
-    for (size_t i = 0; i < len / 4; i++) {
-        dst[i] = __builtin_bswap32(src[i]);
-    }
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16)
+           | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
 }
 
-/*
- * Decode a big-endian length len vector of (unsigned char) into a length
- * len/4 vector of (uint32_t).  Assumes len is a multiple of 4.
- */
-#define be32dec_vect be32enc_vect
-
-#endif /* __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__ */
+static inline void be32enc(unsigned char *p, uint32_t x)
+{
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
 
 /* Elementary functions used by SHA256 */
 #define Ch(x, y, z) ((x & (y ^ z)) ^ z)
@@ -90,68 +77,85 @@ static const uint32_t K[64] = {
     0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
 };
 
+/* Message schedule, kept in a 16 word ring instead of 64 words */
+#define W(i)        W[(i) & 15]
+#define WX(i)       (W(i) += s1(W((i) - 2)) + W((i) - 7) + s0(W((i) - 15)))
+
+/* One round, with the roles of the working variables passed in, so the
+ * rotation of a..h costs nothing when the rounds are unrolled */
+#define RND(a, b, c, d, e, f, g, h, i, w) \
+    do { \
+        uint32_t t0 = h + S1(e) + Ch(e, f, g) + K[i] + (w); \
+        d += t0; \
+        h = t0 + S0(a) + Maj(a, b, c); \
+    } while (0)
+
+#define RND8(i) \
+    do { \
+        RND(a, b, c, d, e, f, g, h, (i) + 0, W((i) + 0)); \
+        RND(h, a, b, c, d, e, f, g, (i) + 1, W((i) + 1)); \
+        RND(g, h, a, b, c, d, e, f, (i) + 2, W((i) + 2)); \
+        RND(f, g, h, a, b, c, d, e, (i) + 3, W((i) + 3)); \
+        RND(e, f, g, h, a, b, c, d, (i) + 4, W((i) + 4)); \
+        RND(d, e, f, g, h, a, b, c, (i) + 5, W((i) + 5)); \
+        RND(c, d, e, f, g, h, a, b, (i) + 6, W((i) + 6)); \
+        RND(b, c, d, e, f, g, h, a, (i) + 7, W((i) + 7)); \
+    } while (0)
+
 /*
  * SHA256 block compression function.  The 256-bit state is transformed via
  * the 512-bit input block to produce a new state.
  */
 static void SHA256_Transform(uint32_t *state, const unsigned char block[64])
 {
-    uint32_t W[64];
-    uint32_t S[8];
+    uint32_t W[16];
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    int i;
 
-    /* 1. Prepare message schedule W. */
-    be32dec_vect(W, block, 64);
-    for (int i = 16; i < 64; i++) {
-        W[i] = s1(W[i - 2]) + W[i - 7] + s0(W[i - 15]) + W[i - 16];
+    for (i = 0; i < 16; i++) {
+        W[i] = be32dec(block + 4 * i);
     }
 
-    /* 2. Initialize working variables. */
-    memcpy(S, state, 32);
-
-    /* 3. Mix. */
-    for (int i = 0; i < 64; ++i) {
-        uint32_t e = S[(68 - i) % 8], f = S[(69 - i) % 8];
-        uint32_t g = S[(70 - i) % 8], h = S[(71 - i) % 8];
-        uint32_t t0 = h + S1(e) + Ch(e, f, g) + W[i] + K[i];
-
-        uint32_t a = S[(64 - i) % 8], b = S[(65 - i) % 8];
-        uint32_t c = S[(66 - i) % 8], d = S[(67 - i) % 8];
-        uint32_t t1 = S0(a) + Maj(a, b, c);
+    /* unrolled by eight only, that keeps the code small enough for MCUs */
+    for (i = 0; i < 64; i += 8) {
+        if (i >= 16) {
+            for (int j = i; j < i + 8; j++) {
+                WX(j);
+            }
+        }
 
-        S[(67 - i) % 8] = d + t0;
-        S[(71 - i) % 8] = t0 + t1;
+        RND8(i);
     }
 
-    /* 4. Mix local working variables into global state */
-    for (int i = 0; i < 8; i++) {
-        state[i] += S[i];
-    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
 }
 
-static unsigned char PAD[64] = {
-    0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-};
-
-/* Add padding and terminating bit-count. */
+/* Add padding and terminating bit-count, straight into the buffer. */
 static void SHA256_Pad(SHA256_CTX *ctx)
 {
-    /*
-     * Convert length to a vector of bytes -- we do this now rather
-     * than later because the length will change after we pad.
-     */
-    unsigned char len[8];
-    be32enc_vect(len, ctx->count, 8);
-
-    /* Add 1--64 bytes so that the resulting length is 56 mod 64 */
     uint32_t r = (ctx->count[1] >> 3) & 0x3f;
-    uint32_t plen = (r < 56) ? (56 - r) : (120 - r);
-    SHA256_Update(ctx, PAD, (size_t) plen);
 
-    /* Add the terminating bit-count */
-    SHA256_Update(ctx, len, 8);
+    ctx->buf[r++] = 0x80;
+
+    /* no room for the length: zero fill and start another block */
+    if (r > 56) {
+        memset(&ctx->buf[r], 0, 64 - r);
+        SHA256_Transform(ctx->state, ctx->buf);
+        r = 0;
+    }
+
+    memset(&ctx->buf[r], 0, 56 - r);
+    be32enc(&ctx->buf[56], ctx->count[0]);
+    be32enc(&ctx->buf[60], ctx->count[1]);
+    SHA256_Transform(ctx->state, ctx->buf);
 }
 
 /* SHA-256 initialization.  Begins a SHA-256 operation. */
@@ -223,7 +227,9 @@ void SHA256_Final(unsigned char digest[32], SHA256_CTX *ctx)
     SHA256_Pad(ctx);
 
     /* Write the hash */
-    be32enc_vect(digest, ctx->state, 32);
+    for (int i = 0; i < 8; i++) {
+        be32enc(digest + 4 * i, ctx->state[i]);
+    }
 
     /* Clear the context state */
     memset((void *) ctx, 0, sizeof(*ctx));
@@ -244,3 +250,121 @@ unsigned char *SHA256(const unsigned char *d, size_t n, unsigned char *md)
 
     return md;
 }
+
+/* HMAC-SHA256 (RFC 2104). The key is reduced to the block size and xored
+ * into the inner and outer pad, both contexts absorb their pad right away,
+ * so only the message is hashed after init. */
+void HMAC_SHA256_Init(HMAC_SHA256_CTX *ctx, const void *key, size_t keylen)
+{
+    unsigned char pad[64], khash[SHA256_DIGEST_LENGTH];
+    const unsigned char *k = key;
+    int i;
+
+    if (keylen > 64) {
+        SHA256(k, keylen, khash);
+        k = khash;
+        keylen = SHA256_DIGEST_LENGTH;
+    }
+
+    memset(pad, 0x36, 64);
+
+    for (i = 0; i < (int) keylen; i++) {
+        pad[i] ^= k[i];
+    }
+
+    SHA256_Init(&ctx->ictx);
+    SHA256_Update(&ctx->ictx, pad, 64);
+
+    memset(pad, 0x5c, 64);
+
+    for (i = 0; i < (int) keylen; i++) {
+        pad[i] ^= k[i];
+    }
+
+    SHA256_Init(&ctx->octx);
+    SHA256_Update(&ctx->octx, pad, 64);
+
+    memset(pad, 0, sizeof(pad));
+    memset(khash, 0, sizeof(khash));
+}
+
+void HMAC_SHA256_Update(HMAC_SHA256_CTX *ctx, const void *in, size_t len)
+{
+    SHA256_Update(&ctx->ictx, in, len);
+}
+
+void HMAC_SHA256_Final(unsigned char digest[32], HMAC_SHA256_CTX *ctx)
+{
+    unsigned char ihash[SHA256_DIGEST_LENGTH];
+
+    SHA256_Final(ihash, &ctx->ictx);
+    SHA256_Update(&ctx->octx, ihash, SHA256_DIGEST_LENGTH);
+    SHA256_Final(digest, &ctx->octx);
+
+    memset(ihash, 0, sizeof(ihash));
+}
+
+unsigned char *HMAC_SHA256(const void *key, size_t keylen,
+                           const unsigned char *d, size_t n,
+                           unsigned char *md)
+{
+    HMAC_SHA256_CTX c;
+
+    HMAC_SHA256_Init(&c, key, keylen);
+    HMAC_SHA256_Update(&c, d, n);
+    HMAC_SHA256_Final(md, &c);
+
+    return md;
+}
+
+/* HKDF (RFC 5869) */
+void HKDF_SHA256_Extract(const void *salt, size_t saltlen,
+                         const void *ikm, size_t ikmlen,
+                         unsigned char prk[32])
+{
+    static const unsigned char zeros[SHA256_DIGEST_LENGTH];
+
+    if (salt == NULL || saltlen == 0) {
+        salt = zeros;
+        saltlen = SHA256_DIGEST_LENGTH;
+    }
+
+    HMAC_SHA256(salt, saltlen, ikm, ikmlen, prk);
+}
+
+int HKDF_SHA256_Expand(const unsigned char prk[32], const void *info,
+                       size_t infolen, unsigned char *okm, size_t okmlen)
+{
+    unsigned char t[SHA256_DIGEST_LENGTH];
+    HMAC_SHA256_CTX c;
+    unsigned char i;
+    size_t done = 0;
+
+    if (okmlen > 255 * SHA256_DIGEST_LENGTH) {
+        return -1;
+    }
+
+    for (i = 1; done < okmlen; i++) {
+        size_t n = okmlen - done;
+
+        HMAC_SHA256_Init(&c, prk, SHA256_DIGEST_LENGTH);
+
+        if (i > 1) {
+            HMAC_SHA256_Update(&c, t, SHA256_DIGEST_LENGTH);
+        }
+
+        HMAC_SHA256_Update(&c, info, infolen);
+        HMAC_SHA256_Update(&c, &i, 1);
+        HMAC_SHA256_Final(t, &c);
+
+        if (n > SHA256_DIGEST_LENGTH) {
+            n = SHA256_DIGEST_LENGTH;
+        }
+
+        memcpy(okm + done, t, n);
+        done += n;
+    }
+
+    memset(t, 0, sizeof(t));
+    return 0;
+}
@@ -110,3 +110,185 @@ uint32_t one_at_a_time_hash(const uint8_t *buf, size_t len)
     hash += hash << 15;
     return hash;
 }
+
+/* little endian loads which work at any alignment */
+static inline uint32_t load32(const uint8_t *p)
+{
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8
+           | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static inline uint64_t load64(const uint8_t *p)
+{
+    return (uint64_t) load32(p) | (uint64_t) load32(p + 4) << 32;
+}
+
+static inline uint32_t rotl32(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+uint32_t murmur3_32_hash(const uint8_t *buf, size_t len)
+{
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    uint32_t hash = 0; /* seed */
+    uint32_t k;
+    size_t i;
+
+    for (i = 0; i + 4 <= len; i += 4) {
+        k = load32(buf + i) * c1;
+        k = rotl32(k, 15) * c2;
+        hash ^= k;
+        hash = rotl32(hash, 13) * 5 + 0xe6546b64;
+    }
+
+    k = 0;
+
+    switch (len & 3) {
+        case 3:
+            k ^= (uint32_t) buf[i + 2] << 16;
+            /* fall through */
+        case 2:
+            k ^= (uint32_t) buf[i + 1] << 8;
+            /* fall through */
+        case 1:
+            k ^= buf[i];
+            k = rotl32(k * c1, 15) * c2;
+            hash ^= k;
+    }
+
+    hash ^= len;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+#define XXH_P1 2654435761U
+#define XXH_P2 2246822519U
+#define XXH_P3 3266489917U
+#define XXH_P4  668265263U
+#define XXH_P5  374761393U
+
+static inline uint32_t xxh32_round(uint32_t acc, uint32_t input)
+{
+    acc += input * XXH_P2;
+    return rotl32(acc, 13) * XXH_P1;
+}
+
+uint32_t xxh32_hash(const uint8_t *buf, size_t len)
+{
+    const uint32_t seed = 0;
+    const uint8_t *end = buf + len;
+    uint32_t hash;
+
+    if (len >= 16) {
+        uint32_t v1 = seed + XXH_P1 + XXH_P2;
+        uint32_t v2 = seed + XXH_P2;
+        uint32_t v3 = seed;
+        uint32_t v4 = seed - XXH_P1;
+
+        do {
+            v1 = xxh32_round(v1, load32(buf));
+            v2 = xxh32_round(v2, load32(buf + 4));
+            v3 = xxh32_round(v3, load32(buf + 8));
+            v4 = xxh32_round(v4, load32(buf + 12));
+            buf += 16;
+        } while (end - buf >= 16);
+
+        hash = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+    }
+    else {
+        hash = seed + XXH_P5;
+    }
+
+    hash += (uint32_t) len;
+
+    while (end - buf >= 4) {
+        hash += load32(buf) * XXH_P3;
+        hash = rotl32(hash, 17) * XXH_P4;
+        buf += 4;
+    }
+
+    while (buf < end) {
+        hash += *buf++ * XXH_P5;
+        hash = rotl32(hash, 11) * XXH_P1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= XXH_P2;
+    hash ^= hash >> 13;
+    hash *= XXH_P3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+#define SIPROUND \
+    do { \
+        v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32); \
+        v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2; \
+        v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0; \
+        v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32); \
+    } while (0)
+
+uint64_t siphash24(const uint8_t *key, const uint8_t *buf, size_t len)
+{
+    uint64_t k0 = load64(key);
+    uint64_t k1 = load64(key + 8);
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+    uint64_t m, b = (uint64_t) len << 56;
+    size_t i, left = len & 7;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        m = load64(buf + i);
+        v3 ^= m;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= m;
+    }
+
+    switch (left) {
+        case 7:
+            b |= (uint64_t) buf[i + 6] << 48;
+            /* fall through */
+        case 6:
+            b |= (uint64_t) buf[i + 5] << 40;
+            /* fall through */
+        case 5:
+            b |= (uint64_t) buf[i + 4] << 32;
+            /* fall through */
+        case 4:
+            b |= (uint64_t) buf[i + 3] << 24;
+            /* fall through */
+        case 3:
+            b |= (uint64_t) buf[i + 2] << 16;
+            /* fall through */
+        case 2:
+            b |= (uint64_t) buf[i + 1] << 8;
+            /* fall through */
+        case 1:
+            b |= (uint64_t) buf[i];
+    }
+
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
@@ -0,0 +1,154 @@
+/**
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ */
+
+/**
+ * @defgroup binlog Binary logging
+ * @ingroup  sys
+ * @{
+ * @file
+ * @brief   Deferred logging without formatting in the caller
+ *
+ * BINLOG() works like printf(), but the caller only stores a record in a
+ * ring buffer: the address of the format string, which serves as its ID,
+ * the arguments as raw 32 bit words and an hwtimer timestamp. A thread at
+ * the lowest priority above idle formats the records later, so logging
+ * costs the caller a few dozen instructions and hardly changes timing.
+ *
+ * In binary mode the thread does not format at all but writes the records
+ * to stdout as frames, dist/tools/binlog/binlog.py turns them back into
+ * text with the help of the ELF file. Other output passes through it
+ * unchanged.
+ *
+ * The arguments are formatted after the call, so they have to be values:
+ * integers up to 32 bit, pointers and characters. %s only works for
+ * strings that live as long as the program, like literals or __func__.
+ * No floating point, no '*' width, at most BINLOG_MAX_ARGS arguments.
+ *
+ * If the ring is full, records are dropped and counted, the count is
+ * reported with the next record that fits.
+ *
+ * @author  Freie Universität Berlin, Computer Systems & Telematics
+ */
+
+#ifndef __BINLOG_H
+#define __BINLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** words in the ring, a power of two; a record takes 3 plus one per argument */
+#ifndef BINLOG_RING_WORDS
+#define BINLOG_RING_WORDS   (256)
+#endif
+
+/** records above this level are compiled out */
+#ifndef BINLOG_LEVEL_MAX
+#define BINLOG_LEVEL_MAX    BINLOG_DEBUG
+#endif
+
+#define BINLOG_MAX_ARGS     (6)
+
+/* levels */
+#define BINLOG_NONE         (0)
+#define BINLOG_ERROR        (1)
+#define BINLOG_WARNING      (2)
+#define BINLOG_INFO         (3)
+#define BINLOG_DEBUG        (4)
+
+/* modules, each has its own level */
+enum {
+    BINLOG_MOD_DEFAULT = 0,
+    BINLOG_MOD_KERNEL,
+    BINLOG_MOD_TRANSCEIVER,
+    BINLOG_MOD_NET,
+    BINLOG_MOD_SIXLOWPAN,
+    BINLOG_MOD_DESTINY,
+    BINLOG_MOD_RPL,
+    BINLOG_MOD_CCNL,
+    BINLOG_MOD_APP,
+    BINLOG_MODULES
+};
+
+/** first bytes of a frame in binary mode, followed by the record */
+#define BINLOG_FRAME_MAGIC0 (0xb1)
+#define BINLOG_FRAME_MAGIC1 (0x06)
+
+/** current level of each module, BINLOG_INFO after binlog_init() */
+extern uint8_t binlog_level[BINLOG_MODULES];
+
+/**
+ * @brief   Logs a message of module mod at level lvl, printf() syntax
+ *
+ * Disabled levels cost a comparison, levels above BINLOG_LEVEL_MAX
+ * nothing.
+ */
+#define BINLOG(mod, lvl, ...) \
+    do { \
+        if (((lvl) <= BINLOG_LEVEL_MAX) && ((lvl) <= binlog_level[mod])) { \
+            _BINLOG_SEL(__VA_ARGS__, _BINLOG6, _BINLOG5, _BINLOG4, \
+                        _BINLOG3, _BINLOG2, _BINLOG1, _BINLOG0, ~) \
+                (mod, lvl, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define _BINLOG_SEL(f, a1, a2, a3, a4, a5, a6, name, ...) name
+#define _BINLOG_A(x)    ((uint32_t)(uintptr_t)(x))
+#define _BINLOG_CALL(m, l, f, ...) \
+    do { \
+        const uint32_t _binlog_args[] = { __VA_ARGS__ }; \
+        binlog_write(m, l, f, sizeof(_binlog_args) / sizeof(uint32_t), \
+                     _binlog_args); \
+    } while (0)
+
+#define _BINLOG0(m, l, f) \
+    binlog_write(m, l, f, 0, NULL)
+#define _BINLOG1(m, l, f, a) \
+    _BINLOG_CALL(m, l, f, _BINLOG_A(a))
+#define _BINLOG2(m, l, f, a, b) \
+    _BINLOG_CALL(m, l, f, _BINLOG_A(a), _BINLOG_A(b))
+#define _BINLOG3(m, l, f, a, b, c) \
+    _BINLOG_CALL(m, l, f, _BINLOG_A(a), _BINLOG_A(b), _BINLOG_A(c))
+#define _BINLOG4(m, l, f, a, b, c, d) \
+    _BINLOG_CALL(m, l, f, _BINLOG_A(a), _BINLOG_A(b), _BINLOG_A(c), \
+                 _BINLOG_A(d))
+#define _BINLOG5(m, l, f, a, b, c, d, e) \
+    _BINLOG_CALL(m, l, f, _BINLOG_A(a), _BINLOG_A(b), _BINLOG_A(c), \
+                 _BINLOG_A(d), _BINLOG_A(e))
+#define _BINLOG6(m, l, f, a, b, c, d, e, g) \
+    _BINLOG_CALL(m, l, f, _BINLOG_A(a), _BINLOG_A(b), _BINLOG_A(c), \
+                 _BINLOG_A(d), _BINLOG_A(e), _BINLOG_A(g))
+
+/**
+ * @brief   Starts the formatting thread, called by auto_init
+ */
+void binlog_init(void);
+
+/**
+ * @brief   Stores a record, use BINLOG() instead. Safe in interrupt context.
+ */
+void binlog_write(unsigned int module, unsigned int level, const char *fmt,
+                  unsigned int nargs, const uint32_t *args);
+
+/**
+ * @brief   Sets the level of a module, BINLOG_NONE turns it off
+ */
+void binlog_set_level(unsigned int module, unsigned int level);
+
+/**
+ * @brief   Chooses between formatting on the node (0) and binary frames
+ *          for binlog.py (1)
+ */
+void binlog_set_binary(int binary);
+
+/**
+ * @return  number of records dropped so far because the ring was full
+ */
+uint32_t binlog_dropped(void);
+
+/** @} */
+#endif /* __BINLOG_H */
@@ -116,7 +116,7 @@
 /**
  * hashfp_t  hash function to use in thee filter
  */
-typedef uint32_t (*hashfp_t)(const uint8_t *, int len);
+typedef uint32_t (*hashfp_t)(const uint8_t *, size_t len);
 
 /**
  * struct bloom_t bloom filter object
@@ -142,6 +142,24 @@ struct bloom_t {
  */
 struct bloom_t *bloom_new(size_t size, size_t num_hashes, ...);
 
+/**
+ * bloom_init  Initialize a Bloom filter on caller provided memory.
+ *
+ * Unlike bloom_new() nothing is allocated, so filters can live in static
+ * memory or be embedded in other structures. The bit array is cleared,
+ * which means bloom_init() can also be used to empty a filter again.
+ *
+ * @param bloom       Bloom filter to initialize
+ * @param size        size of the bit array in bits
+ * @param bitfield    bit array of at least (size + 7) / 8 bytes
+ * @param hashes      array of num_hashes hash functions, must stay valid
+ * @param num_hashes  the number of hash functions
+ * @return nothing
+ *
+ */
+void bloom_init(struct bloom_t *bloom, size_t size, uint8_t *bitfield,
+                hashfp_t *hashes, size_t num_hashes);
+
 /**
  * bloom_del  Delete a Bloom filter.
  *
@@ -0,0 +1,173 @@
+/**
+ * Blocked and counting Bloom filters
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * The filter in bloom.h spreads the k bits of a key over the whole bit
+ * array and runs k hash functions to find them. The filters here hash a
+ * key once, to 64 bits, pick one 64 byte block with part of the hash and
+ * derive the k positions inside the block from the rest by double hashing
+ * (Kirsch and Mitzenmacher, "Less Hashing, Same Performance"):
+ *
+ *      g_i = h1 + i * h2   (mod positions per block)
+ *
+ * So an operation costs one pass over the key and touches one cache line
+ * instead of k. The price is a slightly higher false positive rate than
+ * the classic filter of the same size, since blocks fill unevenly; for
+ * the usual 8 to 16 bits per key the difference is small.
+ *
+ * The counting filter keeps a 4 bit counter instead of each bit (128 per
+ * block), so keys can be removed again. A counter which reaches 15 sticks
+ * there, removals do not touch it, as it cannot tell how often it was
+ * really incremented. bloom_counting_decay() lets all counters fade by
+ * one, for filters which should forget old keys over time.
+ */
+
+/**
+ * @file
+ * @author Freie Universität Berlin, Computer Systems & Telematics
+ */
+
+#ifndef _BLOOM_BLOCKED_H
+#define _BLOOM_BLOCKED_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BLOOM_BLOCK_SIZE    (64)                        /**< bytes */
+#define BLOOM_BLOCK_WORDS   (BLOOM_BLOCK_SIZE / 4)
+
+/**
+ * bloom_block_t  one cache line worth of filter
+ */
+typedef struct {
+    uint32_t w[BLOOM_BLOCK_WORDS];
+} bloom_block_t;
+
+/**
+ * BLOOM_BLOCKS  number of blocks for a filter of at least 'bits' bits,
+ * use it to size the array for bloom_blocked_init()
+ */
+#define BLOOM_BLOCKS(bits)  (((bits) + BLOOM_BLOCK_SIZE * 8 - 1) \
+                             / (BLOOM_BLOCK_SIZE * 8))
+
+/**
+ * struct bloom_blocked_t  blocked bloom filter object
+ */
+struct bloom_blocked_t {
+    bloom_block_t *blocks;
+    size_t nblocks;
+    size_t k;
+};
+
+/**
+ * struct bloom_counting_t  counting blocked bloom filter object
+ */
+struct bloom_counting_t {
+    bloom_block_t *blocks;
+    size_t nblocks;
+    size_t k;
+};
+
+/**
+ * bloom_hash64  The hash the filters use, MurmurHash64A.
+ * @param buf  input buffer to hash
+ * @param len  length of buffer
+ * @return     64 bit sized hash
+ */
+uint64_t bloom_hash64(const uint8_t *buf, size_t len);
+
+/**
+ * bloom_blocked_init  Initialize a blocked Bloom filter on caller provided
+ * memory and clear it.
+ * @param bloom       Bloom filter to initialize
+ * @param blocks      array of nblocks blocks
+ * @param nblocks     number of blocks, see BLOOM_BLOCKS()
+ * @param num_hashes  number of bits set per key, 1 to 16
+ * @return nothing
+ */
+void bloom_blocked_init(struct bloom_blocked_t *bloom, bloom_block_t *blocks,
+                        size_t nblocks, size_t num_hashes);
+
+/**
+ * bloom_blocked_add  Add a string to a blocked Bloom filter.
+ * @param bloom  Bloom filter
+ * @param buf    string to add
+ * @param len    length of buf
+ * @return       nothing
+ */
+void bloom_blocked_add(struct bloom_blocked_t *bloom, const uint8_t *buf,
+                       size_t len);
+
+/**
+ * bloom_blocked_check  Determine if a string is in a blocked Bloom filter.
+ * @param bloom  Bloom filter
+ * @param buf    string to check
+ * @param len    length of buf
+ * @return       false if string does not exist in the filter
+ * @return       true if string may be in the filter
+ */
+bool bloom_blocked_check(struct bloom_blocked_t *bloom, const uint8_t *buf,
+                         size_t len);
+
+/**
+ * bloom_counting_init  Initialize a counting Bloom filter on caller
+ * provided memory and clear it.
+ * @param bloom       Bloom filter to initialize
+ * @param blocks      array of nblocks blocks, 128 counters each
+ * @param nblocks     number of blocks
+ * @param num_hashes  number of counters incremented per key, 1 to 16
+ * @return nothing
+ */
+void bloom_counting_init(struct bloom_counting_t *bloom, bloom_block_t *blocks,
+                         size_t nblocks, size_t num_hashes);
+
+/**
+ * bloom_counting_add  Add a string to a counting Bloom filter.
+ * @param bloom  Bloom filter
+ * @param buf    string to add
+ * @param len    length of buf
+ * @return       nothing
+ */
+void bloom_counting_add(struct bloom_counting_t *bloom, const uint8_t *buf,
+                        size_t len);
+
+/**
+ * bloom_counting_remove  Remove a string from a counting Bloom filter.
+ * CAVEAT
+ * Only remove what has been added before, otherwise other strings may
+ * drop out of the filter, too.
+ * @param bloom  Bloom filter
+ * @param buf    string to remove
+ * @param len    length of buf
+ * @return       nothing
+ */
+void bloom_counting_remove(struct bloom_counting_t *bloom, const uint8_t *buf,
+                           size_t len);
+
+/**
+ * bloom_counting_check  Determine if a string is in a counting Bloom filter.
+ * @param bloom  Bloom filter
+ * @param buf    string to check
+ * @param len    length of buf
+ * @return       false if string does not exist in the filter
+ * @return       true if string may be in the filter
+ */
+bool bloom_counting_check(struct bloom_counting_t *bloom, const uint8_t *buf,
+                          size_t len);
+
+/**
+ * bloom_counting_decay  Decrement every counter which is not zero,
+ * saturated ones included. A string stays in the filter for as many
+ * decays as the lowest of its counters says.
+ * @param bloom  Bloom filter
+ * @return       nothing
+ */
+void bloom_counting_decay(struct bloom_counting_t *bloom);
+
+#endif /* _BLOOM_BLOCKED_H */
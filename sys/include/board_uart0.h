@@ -7,7 +7,19 @@ void board_uart0_init(void);
 void uart0_handle_incoming(int c);
 void uart0_notify_thread(void);
 
+/** @return number of bytes uart0_handle_incoming() can take without
+ *          dropping any */
+int uart0_rx_free(void);
+
 int uart0_readc(void);
 void uart0_putc(int c);
 
+/**
+ * @brief   Opens uart0 for reading by the calling thread as file
+ *          descriptor, see fd.h. Needs module posix.
+ *
+ * @return  the fd, -1 if uart0 is already open or the fd table is full
+ */
+int uart0_fd_open(void);
+
 #endif /* __BOARD_UART0_H */
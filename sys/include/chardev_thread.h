@@ -1,8 +1,8 @@
 #ifndef __CHARDEV_THREAD_H
 #define __CHARDEV_THREAD_H
 
-#include <ringbuffer.h>
+#include <tsrb.h>
 
-void chardev_loop(ringbuffer_t *rb);
+void chardev_loop(tsrb_t *rb);
 
 #endif /* __CHARDEV_THREAD_H */
@@ -0,0 +1,131 @@
+/**
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ */
+
+/**
+ * @addtogroup posix
+ * @{
+ * @file
+ * @brief   File descriptors and poll()
+ *
+ * A file descriptor is a small integer naming an I/O source: a character
+ * device, a destiny socket or the calling thread's message queue. Each
+ * source type supplies an fd_ops_t, the descriptor stores it together
+ * with the source's own handle ('internal', e.g. the socket number).
+ *
+ * fd_poll() waits for several descriptors at once from a single thread.
+ * It asks each source whether it is ready via the poll operation and, if
+ * none is, blocks until a source calls fd_notify() (from a thread or an
+ * interrupt handler), a message arrives or the timeout expires.
+ *
+ * Only one thread at a time should poll a descriptor, a second poller
+ * replaces the first as the one to be woken.
+ *
+ * @author  Freie Universität Berlin, Computer Systems & Telematics
+ */
+#ifndef __FD_H
+#define __FD_H
+
+#ifndef FD_MAX
+#define FD_MAX          (8)
+#endif
+
+#ifndef POLLIN
+#define POLLIN          (0x0001)    /**< data can be read without blocking */
+#define POLLOUT         (0x0004)    /**< data can be written without blocking */
+#define POLLERR         (0x0008)    /**< error, always reported */
+#define POLLHUP         (0x0010)    /**< peer closed, always reported */
+#define POLLNVAL        (0x0020)    /**< fd not open, always reported */
+#endif
+
+/**
+ * Operations of one type of I/O source, 'internal' is the handle stored
+ * with fd_new(). Unsupported operations may be NULL.
+ */
+typedef struct fd_ops_t {
+    int (*read)(int internal, char *buffer, int bufsize);
+    int (*write)(int internal, const char *buffer, int bufsize);
+    int (*close)(int internal);
+    /** Non-blocking, called with interrupts disabled: POLLIN, POLLOUT,
+     *  POLLERR and POLLHUP as they currently apply */
+    int (*poll)(int internal);
+} fd_ops_t;
+
+typedef struct fd_t {
+    const fd_ops_t *ops;    /**< NULL if the fd is free */
+    int internal;
+    int waiter;             /**< pid blocked in fd_poll() on this fd or -1 */
+} fd_t;
+
+struct fd_pollfd {
+    int fd;                 /**< ignored if negative */
+    short events;           /**< POLLIN and/or POLLOUT */
+    short revents;          /**< set by fd_poll() */
+};
+
+/** The calling thread's message queue, readable while a message is
+ *  waiting. Reading receives it, bufsize has to be sizeof(msg_t). */
+extern const fd_ops_t fd_msg_ops;
+
+/**
+ * @brief   Allocates a file descriptor
+ *
+ * @return  the fd, -1 if the table is full
+ */
+int fd_new(const fd_ops_t *ops, int internal);
+
+/**
+ * @return  the descriptor, NULL if fd is not open
+ */
+fd_t *fd_get(int fd);
+
+/**
+ * @brief   Releases fd without closing the source
+ */
+void fd_destroy(int fd);
+
+/**
+ * @brief   Opens the calling thread's message queue as file descriptor
+ *
+ * @return  the fd, -1 if the table is full
+ */
+int fd_msg_open(void);
+
+int fd_read(int fd, char *buffer, int bufsize);
+int fd_write(int fd, const char *buffer, int bufsize);
+
+/**
+ * @brief   Closes the source and releases fd
+ */
+int fd_close(int fd);
+
+/**
+ * @brief   Wakes the thread polling the descriptors of a source
+ *
+ * Sources call this when they may have become ready. It is cheap and safe
+ * to call from interrupt context, spurious calls only cost the poller a
+ * look at its descriptors.
+ */
+void fd_notify(const fd_ops_t *ops, int internal);
+
+/**
+ * @brief   Waits until one of the descriptors is ready
+ *
+ * @param   fds     descriptors and the events of interest, revents is set
+ *                  for every entry
+ * @param   nfds    number of entries in fds
+ * @param   timeout in milliseconds, 0 to return at once, negative to wait
+ *                  without limit
+ *
+ * @return  number of entries with revents set, 0 on timeout
+ */
+int fd_poll(struct fd_pollfd *fds, unsigned int nfds, int timeout);
+
+/**
+ * @}
+ */
+#endif /* __FD_H */
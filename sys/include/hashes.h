@@ -147,3 +147,54 @@ uint32_t rotating_hash(const uint8_t *buf, size_t len);
  * @return 32 bit sized hash
  */
 uint32_t one_at_a_time_hash(const uint8_t *buf, size_t len);
+
+/**
+ * @brief murmur3_32_hash
+ *
+ * MurmurHash3, x86 32 bit variant, by Austin Appleby (public domain),
+ * with seed 0. Works on four bytes per round and mixes well, the
+ * better choice for hash tables than the byte-at-a-time hashes above.
+ *
+ * found on
+ * https://code.google.com/p/smhasher/
+ *
+ * @param buf input buffer to hash, no alignment required
+ * @param len length of buffer
+ * @return 32 bit sized hash
+ */
+uint32_t murmur3_32_hash(const uint8_t *buf, size_t len);
+
+/**
+ * @brief xxh32_hash
+ *
+ * xxHash, 32 bit variant, by Yann Collet (BSD license), with seed 0.
+ * Runs four independent lanes over 16 byte stripes, which makes it the
+ * fastest hash here on longer inputs.
+ *
+ * found on
+ * https://code.google.com/p/xxhash/
+ *
+ * @param buf input buffer to hash, no alignment required
+ * @param len length of buffer
+ * @return 32 bit sized hash
+ */
+uint32_t xxh32_hash(const uint8_t *buf, size_t len);
+
+/**
+ * @brief siphash24
+ *
+ * SipHash-2-4 by Jean-Philippe Aumasson and Daniel J. Bernstein, a keyed
+ * hash. Without the key an attacker cannot predict which inputs collide,
+ * so use it for tables whose keys come from the network (names, nonces,
+ * addresses in received packets), with a random key per boot. It is
+ * slower than the unkeyed hashes, in particular on 8 and 16 bit CPUs.
+ *
+ * found on
+ * https://131002.net/siphash/
+ *
+ * @param key 16 byte secret key
+ * @param buf input buffer to hash, no alignment required
+ * @param len length of buffer
+ * @return 64 bit sized hash
+ */
+uint64_t siphash24(const uint8_t *key, const uint8_t *buf, size_t len);
@@ -1,3 +1,6 @@
+#ifndef __RANDOM_H
+#define __RANDOM_H
+
 #include <inttypes.h>
 
 #ifndef PRNG_FLOAT
@@ -57,3 +60,116 @@ double genrand_real_exclusive(void);
 double genrand_res53(void);
 
 #endif /* PRNG_FLOAT */
+
+/*
+ * Small-state generators
+ *
+ * The Mersenne Twister above keeps 2.5 KB of state and regenerates all
+ * of it every 624 outputs. The generators below keep 16 bytes, produce
+ * every output in constant time and can be instantiated as often as
+ * needed, so a thread or module can own its generator instead of sharing
+ * (and locking) a global one.
+ *
+ * xoshiro128** (Blackman and Vigna): 32 bit operations only, the default
+ * on MCUs. pcg32 (O'Neill): needs a 64 bit multiply, but has independent
+ * streams selected by 'seq'.
+ */
+
+typedef struct {
+    uint32_t s[4];
+} xoshiro128_t;
+
+typedef struct {
+    uint64_t state;
+    uint64_t inc;
+} pcg32_t;
+
+/**
+ * @brief initializes a xoshiro128** generator from a 32 bit seed
+ */
+void xoshiro128_init(xoshiro128_t *g, uint32_t seed);
+
+/**
+ * @brief generates a random number on [0,0xffffffff]-interval
+ */
+uint32_t xoshiro128_next(xoshiro128_t *g);
+
+/**
+ * @brief generates a random number on [0,n)-interval, without modulo bias
+ */
+uint32_t xoshiro128_bounded(xoshiro128_t *g, uint32_t n);
+
+/**
+ * @brief initializes a pcg32 generator
+ *
+ * @param seed starting state
+ * @param seq  stream, generators with different seq never share outputs
+ */
+void pcg32_init(pcg32_t *g, uint64_t seed, uint64_t seq);
+
+/**
+ * @brief generates a random number on [0,0xffffffff]-interval
+ */
+uint32_t pcg32_next(pcg32_t *g);
+
+/**
+ * @brief generates a random number on [0,n)-interval, without modulo bias
+ */
+uint32_t pcg32_bounded(pcg32_t *g, uint32_t n);
+
+/*
+ * The default generator
+ *
+ * random_*() draw from one global generator, picked at compile time with
+ * PRNG_BACKEND. It is not locked: threads and interrupt handlers which
+ * draw concurrently should have their own generator.
+ */
+
+#define PRNG_MERSENNE   (0)
+#define PRNG_XOSHIRO    (1)
+#define PRNG_PCG32      (2)
+
+#ifndef PRNG_BACKEND
+#  define PRNG_BACKEND PRNG_XOSHIRO
+#endif
+
+/**
+ * @brief seeds the default generator
+ *
+ * @param s seed for the PRNG
+ */
+void random_init(uint32_t s);
+
+/**
+ * @brief seeds the default generator from /dev/urandom on native,
+ * from timer jitter elsewhere
+ *
+ * @return the seed used, for reproducing a run with random_init()
+ */
+uint32_t random_init_entropy(void);
+
+/**
+ * @brief generates a random number on [0,0xffffffff]-interval
+ */
+uint32_t random_uint32(void);
+
+/**
+ * @brief generates a random number on [0,n)-interval, without modulo bias
+ *
+ * Lemire's multiply-shift method: one multiplication, a division only in
+ * the rare case that a draw has to be rejected.
+ */
+uint32_t random_bounded(uint32_t n);
+
+/**
+ * @brief generates a random number on [lo,hi)-interval
+ */
+uint32_t random_range(uint32_t lo, uint32_t hi);
+
+/**
+ * @brief generates a random fraction on [0,1)-interval in Q0.16 fixed
+ * point, e.g. (x * random_q16()) >> 16 is uniform on [0,x)
+ */
+uint16_t random_q16(void);
+
+#endif /* __RANDOM_H */
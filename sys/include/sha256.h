@@ -77,4 +77,77 @@ void SHA256_Final(unsigned char digest[32], SHA256_CTX *ctx);
  */
 unsigned char *SHA256(const unsigned char *d, size_t n,unsigned char *md);
 
+typedef struct HMAC_SHA256Context {
+    SHA256_CTX ictx;
+    SHA256_CTX octx;
+} HMAC_SHA256_CTX;
+
+/**
+ * @brief HMAC-SHA256 initialization (RFC 2104).  Begins an HMAC operation.
+ *
+ * @param ctx     HMAC_SHA256_CTX handle to init
+ * @param key     the secret key
+ * @param keylen  length of the key, keys longer than 64 bytes are hashed
+ */
+void HMAC_SHA256_Init(HMAC_SHA256_CTX *ctx, const void *key, size_t keylen);
+
+/**
+ * @brief Add bytes into the HMAC
+ *
+ * @param ctx  HMAC_SHA256_CTX handle to use
+ * @param in   pointer to the input buffer
+ * @param len  length of the buffer
+ */
+void HMAC_SHA256_Update(HMAC_SHA256_CTX *ctx, const void *in, size_t len);
+
+/**
+ * @brief HMAC-SHA256 finalization.  Exports the MAC and clears the context.
+ *
+ * @param digest resulting MAC
+ * @param ctx    HMAC_SHA256_CTX handle to use
+ */
+void HMAC_SHA256_Final(unsigned char digest[32], HMAC_SHA256_CTX *ctx);
+
+/**
+ * @brief A wrapper function to compute the HMAC-SHA256 of one buffer
+ *
+ * @param key    the secret key
+ * @param keylen length of the key
+ * @param d      pointer to the buffer to authenticate
+ * @param n      length of the buffer
+ * @param md     array for the result, length must be SHA256_DIGEST_LENGTH
+ */
+unsigned char *HMAC_SHA256(const void *key, size_t keylen,
+                           const unsigned char *d, size_t n,
+                           unsigned char *md);
+
+/**
+ * @brief HKDF-Extract (RFC 5869), condenses input keying material into a
+ * pseudorandom key
+ *
+ * @param salt    optional salt, NULL or saltlen 0: 32 zero bytes
+ * @param saltlen length of the salt
+ * @param ikm     input keying material
+ * @param ikmlen  length of ikm
+ * @param prk     resulting pseudorandom key
+ */
+void HKDF_SHA256_Extract(const void *salt, size_t saltlen,
+                         const void *ikm, size_t ikmlen,
+                         unsigned char prk[32]);
+
+/**
+ * @brief HKDF-Expand (RFC 5869), derives okmlen bytes of keying material
+ * for the purpose named by info
+ *
+ * @param prk     pseudorandom key from HKDF_SHA256_Extract()
+ * @param info    context and application specific information, may be empty
+ * @param infolen length of info
+ * @param okm     output keying material
+ * @param okmlen  number of bytes to derive, at most 255 * 32
+ *
+ * @return 0 on success, -1 if okmlen is too large
+ */
+int HKDF_SHA256_Expand(const unsigned char prk[32], const void *info,
+                       size_t infolen, unsigned char *okm, size_t okmlen);
+
 #endif /* !_SHA256_H_ */
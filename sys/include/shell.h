@@ -26,10 +26,19 @@ typedef struct shell_command_t {
     void (*handler)(char *);
 } shell_command_t;
 
+/**
+ * @brief Slots of an optional command name hash table in every shell_t,
+ *        e.g. CFLAGS += -DSHELL_INDEX_SIZE=32. Without it, or for the
+ *        commands beyond it, commands are found by a linear search.
+ */
 typedef struct shell_t {
     const shell_command_t *command_list;
     int (*readchar)(void);
     void (*put_char)(int);
+#ifdef SHELL_INDEX_SIZE
+    const shell_command_t *index[SHELL_INDEX_SIZE];
+    int index_complete;
+#endif
 } shell_t;
 
 #define SHELL_BUFFER_SIZE (127)
@@ -45,9 +54,20 @@ void shell_init(shell_t *shell,  /*@null@*/ const shell_command_t *shell_command
 
 /**
  * @brief Endless loop that waits for command and executes handler.
+ *
+ * A line may hold several commands separated by ';'. Besides help, the
+ * builtins "repeat <n> <command>" and "time <command>" (wall time and
+ * hwtimer ticks) are understood, lines starting with '#' are comments.
  */
 void shell_run(shell_t *shell);
 
+/**
+ * @brief Executes a script, one command line per line, and returns.
+ * @param shell Initialized shell object
+ * @param script Zero terminated lines, see shell_run() for their syntax
+ */
+void shell_run_script(shell_t *shell, const char *script);
+
 
 void shell_auto_init(shell_t *shell);
 
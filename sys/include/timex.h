@@ -39,4 +39,46 @@ void timex_normalize(timex_t *time);
  */
 void timex_print(const timex_t t);
 
+/**
+ * Time in microseconds, 64 bit wide.
+ *
+ * Timestamps do not wrap within the lifetime of a node, so adding and
+ * subtracting are single integer operations and comparing needs no
+ * normalization. Use timex_t only where an API still wants it.
+ */
+typedef uint64_t timex64_t;
+
+#define TIMEX64_SECOND  (1000000ULL)
+
+/**
+ * @brief Converts a timex_t, which need not be normalized, to microseconds
+ */
+timex64_t timex_to_64(const timex_t t);
+
+/**
+ * @brief Converts microseconds to a normalized timex_t
+ */
+timex_t timex_from_64(timex64_t us);
+
+/**
+ * @brief Signed difference a-b, correct across a wrap of the counter as
+ * long as a and b are less than 2^63 microseconds apart
+ *
+ * @return negative when a is before b
+ */
+static inline int64_t timex64_delta(timex64_t a, timex64_t b)
+{
+    return (int64_t)(a - b);
+}
+
+/**
+ * @brief Compares two timex64_t values without branching
+ *
+ * @return -1 when a is smaller, 0 if equal, 1 if a is bigger
+ */
+static inline int timex64_cmp(timex64_t a, timex64_t b)
+{
+    return (a > b) - (a < b);
+}
+
 #endif /* __TIMEX_H */
@@ -45,6 +45,12 @@ typedef struct vtimer_t {
  */
 void vtimer_now(timex_t *out);
 
+/**
+ * @brief   Current system time
+ * @return  Microseconds since system boot
+ */
+timex64_t vtimer_now64(void);
+
 /**
  * @brief   Initializes the vtimer subsystem. To be called once at system initialization. Will be initialized by auto_init.
  *
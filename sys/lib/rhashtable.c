@@ -0,0 +1,334 @@
+/**
+ * Open addressing hash table (Robin Hood hashing)
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup sys_lib
+ * @{
+ * @file   rhashtable.c
+ * @}
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "rhashtable.h"
+
+#define OWN_TABLE   (1)
+#define OWN_OLD     (2)
+#define OWN_SELF    (4)
+
+/* grow once a growable table is 7/8 full */
+#define LIMIT(mask) ((mask) + 1 - (((mask) + 1) >> 3))
+
+/* the slot index is taken from the low bits, so mix the caller's hash
+ * (murmur3 finalizer); 0 marks an empty slot */
+static uint32_t rht_hash(rhashtable_t *h, void *k)
+{
+    uint32_t x = h->hashfn(k);
+
+    x ^= x >> 16;
+    x *= 0x85ebca6b;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35;
+    x ^= x >> 16;
+    return x ? x : 1;
+}
+
+/* how far the entry in slot i is away from its home slot */
+static inline unsigned int dist(uint32_t hv, unsigned int i, unsigned int mask)
+{
+    return (i - hv) & mask;
+}
+
+static int slot_find(rhashtable_t *h, rhashtable_slot_t *tab,
+                     unsigned int mask, uint32_t hv, void *k)
+{
+    unsigned int i = hv & mask, d;
+
+    for (d = 0;; d++, i = (i + 1) & mask) {
+        rhashtable_slot_t *s = tab + i;
+
+        /* k would have taken this slot */
+        if (!s->h || dist(s->h, i, mask) < d) {
+            return -1;
+        }
+
+        if (s->h == hv && h->eqfn(s->k, k)) {
+            return i;
+        }
+    }
+}
+
+/* tab must have a free slot and must not hold k yet */
+static void slot_put(rhashtable_slot_t *tab, unsigned int mask,
+                     uint32_t hv, void *k, void *v)
+{
+    rhashtable_slot_t e, tmp;
+    unsigned int i = hv & mask, d, sd;
+
+    e.k = k;
+    e.v = v;
+    e.h = hv;
+
+    for (d = 0;; d++, i = (i + 1) & mask) {
+        rhashtable_slot_t *s = tab + i;
+
+        if (!s->h) {
+            *s = e;
+            return;
+        }
+
+        sd = dist(s->h, i, mask);
+
+        if (sd < d) { /* take from the rich, carry the displaced one on */
+            tmp = *s;
+            *s = e;
+            e = tmp;
+            d = sd;
+        }
+    }
+}
+
+/* backward shift deletion: pull the following run one slot closer home */
+static void slot_delete(rhashtable_slot_t *tab, unsigned int mask,
+                        unsigned int i)
+{
+    unsigned int next = (i + 1) & mask;
+
+    while (tab[next].h && dist(tab[next].h, next, mask)) {
+        tab[i] = tab[next];
+        i = next;
+        next = (i + 1) & mask;
+    }
+
+    tab[i].h = 0;
+}
+
+static void rht_resize_done(rhashtable_t *h)
+{
+    if (h->owned & OWN_OLD) {
+        free(h->old);
+    }
+
+    h->owned &= ~OWN_OLD;
+    h->old = NULL;
+}
+
+/* Move up to n entries from the old to the new array. The cursor stays on
+ * a slot until it is empty: removing its entry may shift the next one in.
+ * Behind the cursor the old array is empty, so the probe sequences of the
+ * entries still in there are unaffected. */
+static void rht_migrate(rhashtable_t *h, unsigned int n)
+{
+    while (h->old && n--) {
+        rhashtable_slot_t *s = h->old + h->cursor;
+
+        if (s->h) {
+            slot_put(h->table, h->mask, s->h, s->k, s->v);
+            slot_delete(h->old, h->oldmask, h->cursor);
+            h->count++;
+            h->oldcount--;
+        }
+        else {
+            h->cursor++;
+        }
+
+        if (!h->oldcount || h->cursor > h->oldmask) {
+            rht_resize_done(h);
+        }
+    }
+}
+
+static int rht_grow(rhashtable_t *h)
+{
+    unsigned int size = (h->mask + 1) << 1;
+    rhashtable_slot_t *tab;
+
+    if (!size || !(h->flags & RHASHTABLE_GROW)) {
+        return 0;
+    }
+
+    tab = (rhashtable_slot_t *) calloc(size, sizeof(rhashtable_slot_t));
+
+    if (!tab) {
+        return 0;
+    }
+
+    h->old = h->table;
+    h->oldmask = h->mask;
+    h->oldcount = h->count;
+    h->cursor = 0;
+
+    if (h->owned & OWN_TABLE) {
+        h->owned |= OWN_OLD;
+    }
+
+    h->owned |= OWN_TABLE;
+    h->table = tab;
+    h->mask = size - 1;
+    h->count = 0;
+    return 1;
+}
+
+int rhashtable_init(rhashtable_t *h, rhashtable_slot_t *slots,
+                    unsigned int size, unsigned int (*hashfn)(void *),
+                    int (*eqfn)(void *, void *), unsigned int flags)
+{
+    unsigned int i;
+
+    if (!size || (size & (size - 1))) {
+        return -1;
+    }
+
+    for (i = 0; i < size; i++) {
+        slots[i].h = 0;
+    }
+
+    h->table = slots;
+    h->mask = size - 1;
+    h->count = 0;
+    h->old = NULL;
+    h->oldmask = 0;
+    h->oldcount = 0;
+    h->cursor = 0;
+    h->flags = flags;
+    h->owned = 0;
+    h->hashfn = hashfn;
+    h->eqfn = eqfn;
+    return 0;
+}
+
+rhashtable_t *rhashtable_create(unsigned int minsize,
+                                unsigned int (*hashfn)(void *),
+                                int (*eqfn)(void *, void *))
+{
+    unsigned int size = 8;
+    rhashtable_slot_t *slots;
+    rhashtable_t *h;
+
+    while (LIMIT(size - 1) < minsize) {
+        if (size > (UINT_MAX >> 1)) {
+            return NULL;
+        }
+
+        size <<= 1;
+    }
+
+    h = (rhashtable_t *) malloc(sizeof(rhashtable_t));
+    slots = (rhashtable_slot_t *) malloc(size * sizeof(rhashtable_slot_t));
+
+    if (!h || !slots) {
+        free(slots);
+        free(h);
+        return NULL;
+    }
+
+    rhashtable_init(h, slots, size, hashfn, eqfn, RHASHTABLE_GROW);
+    h->owned = OWN_TABLE | OWN_SELF;
+    return h;
+}
+
+int rhashtable_insert(rhashtable_t *h, void *k, void *v)
+{
+    uint32_t hv = rht_hash(h, k);
+    int i;
+
+    rht_migrate(h, RHASHTABLE_MIGRATE);
+
+    if ((i = slot_find(h, h->table, h->mask, hv, k)) >= 0) {
+        h->table[i].v = v;
+        return 1;
+    }
+
+    if (h->old && (i = slot_find(h, h->old, h->oldmask, hv, k)) >= 0) {
+        h->old[i].v = v;
+        return 1;
+    }
+
+    if (h->count + h->oldcount >= LIMIT(h->mask)) {
+        /* cannot happen with RHASHTABLE_MIGRATE > 1, but be safe */
+        rht_migrate(h, UINT_MAX);
+
+        if (!rht_grow(h) && h->count > h->mask) {
+            return 0;
+        }
+    }
+
+    slot_put(h->table, h->mask, hv, k, v);
+    h->count++;
+    return 1;
+}
+
+void *rhashtable_search(rhashtable_t *h, void *k)
+{
+    uint32_t hv = rht_hash(h, k);
+    int i;
+
+    if ((i = slot_find(h, h->table, h->mask, hv, k)) >= 0) {
+        return h->table[i].v;
+    }
+
+    if (h->old && (i = slot_find(h, h->old, h->oldmask, hv, k)) >= 0) {
+        return h->old[i].v;
+    }
+
+    return NULL;
+}
+
+void *rhashtable_remove(rhashtable_t *h, void *k)
+{
+    uint32_t hv = rht_hash(h, k);
+    void *v = NULL;
+    int i;
+
+    rht_migrate(h, RHASHTABLE_MIGRATE);
+
+    if ((i = slot_find(h, h->table, h->mask, hv, k)) >= 0) {
+        v = h->table[i].v;
+        slot_delete(h->table, h->mask, i);
+        h->count--;
+    }
+    else if (h->old && (i = slot_find(h, h->old, h->oldmask, hv, k)) >= 0) {
+        v = h->old[i].v;
+        slot_delete(h->old, h->oldmask, i);
+
+        if (!--h->oldcount) {
+            rht_resize_done(h);
+        }
+    }
+
+    return v;
+}
+
+unsigned int rhashtable_count(rhashtable_t *h)
+{
+    return h->count + h->oldcount;
+}
+
+void rhashtable_destroy(rhashtable_t *h)
+{
+    if (h->owned & OWN_OLD) {
+        free(h->old);
+    }
+
+    if (h->owned & OWN_TABLE) {
+        free(h->table);
+    }
+
+    if (h->owned & OWN_SELF) {
+        free(h);
+        return;
+    }
+
+    h->old = NULL;
+    h->table = NULL;
+    h->count = 0;
+    h->oldcount = 0;
+    h->owned = 0;
+}
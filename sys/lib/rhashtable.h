@@ -0,0 +1,119 @@
+/**
+ * Open addressing hash table (Robin Hood hashing)
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup sys_lib
+ * @{
+ * @file   rhashtable.h
+ * @brief  Hash table without per-entry allocation
+ *
+ * All entries live in one array of slots, sized to a power of two. On a
+ * collision an entry moves on to the next slot, but takes the place of
+ * any entry which is closer to its home slot than the new one would be
+ * ("Robin Hood"), which keeps probe sequences short up to high loads.
+ * Removal shifts the following entries back, so no tombstones are left.
+ *
+ * The slot array is provided by the caller. A table initialised with
+ * RHASHTABLE_GROW doubles its size once it is 7/8 full, using malloc.
+ * Entries are moved over a few slots per insert or remove, so there is
+ * never a single operation which rehashes the whole table. Without the
+ * flag the table never allocates and insertion fails once it is full.
+ *
+ * Keys and values are owned by the caller.
+ * @}
+ */
+
+#ifndef __RHASHTABLE_H
+#define __RHASHTABLE_H
+
+#include <stdint.h>
+
+/** the table may allocate larger slot arrays on its own */
+#define RHASHTABLE_GROW     (1)
+
+/** slots moved from the old to the new array per insert or remove */
+#define RHASHTABLE_MIGRATE  (4)
+
+typedef struct {
+    void *k, *v;
+    uint32_t h;                 /**< 0: empty slot */
+} rhashtable_slot_t;
+
+typedef struct rhashtable {
+    rhashtable_slot_t *table;
+    unsigned int mask;          /**< number of slots - 1 */
+    unsigned int count;         /**< entries in table */
+    rhashtable_slot_t *old;     /**< while resizing: the previous array */
+    unsigned int oldmask;
+    unsigned int oldcount;
+    unsigned int cursor;        /**< next slot of old to be moved */
+    unsigned int flags;
+    unsigned int owned;         /**< what has to be freed on destroy */
+    unsigned int (*hashfn)(void *k);
+    int (*eqfn)(void *k1, void *k2);
+} rhashtable_t;
+
+/**
+ * @brief   Initialise a table on caller provided storage
+ *
+ * @param   h       the table
+ * @param   slots   array of size slots, stays in use until the table is
+ *                  destroyed or has grown out of it
+ * @param   size    number of slots, a power of two
+ * @param   hashfn  function for hashing keys
+ * @param   eqfn    function for determining key equality
+ * @param   flags   0 or RHASHTABLE_GROW
+ *
+ * @return  0 on success, -1 if size is not a power of two
+ */
+int rhashtable_init(rhashtable_t *h, rhashtable_slot_t *slots,
+                    unsigned int size, unsigned int (*hashfn)(void *),
+                    int (*eqfn)(void *, void *), unsigned int flags);
+
+/**
+ * @brief   Allocate a growable table with room for at least minsize entries
+ *
+ * @return  the table, NULL if out of memory
+ */
+rhashtable_t *rhashtable_create(unsigned int minsize,
+                                unsigned int (*hashfn)(void *),
+                                int (*eqfn)(void *, void *));
+
+/**
+ * @brief   Insert k, or replace the value if k is already present
+ *
+ * @return  non-zero on success, 0 if the table is full
+ */
+int rhashtable_insert(rhashtable_t *h, void *k, void *v);
+
+/**
+ * @brief   Look up k
+ *
+ * @return  the value associated with k, NULL if not found
+ */
+void *rhashtable_search(rhashtable_t *h, void *k);
+
+/**
+ * @brief   Remove k
+ *
+ * @return  the value associated with k, NULL if not found
+ */
+void *rhashtable_remove(rhashtable_t *h, void *k);
+
+/**
+ * @brief   Number of entries
+ */
+unsigned int rhashtable_count(rhashtable_t *h);
+
+/**
+ * @brief   Release the slot arrays the table allocated itself, and the
+ *          table if it came from rhashtable_create()
+ */
+void rhashtable_destroy(rhashtable_t *h);
+
+#endif /* __RHASHTABLE_H */
@@ -0,0 +1,164 @@
+/**
+ * Thread safe ringbuffer implementation
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup sys_lib
+ * @{
+ * @file   tsrb.c
+ * @}
+ */
+
+#include <string.h>
+
+#include "tsrb.h"
+
+/* the other side's counter may change at any time, read it from memory */
+#define LOAD(x) (*(volatile unsigned int *) &(x))
+
+/* Publish a counter: the barrier keeps the compiler from moving the buffer
+ * accesses behind the store, and a word store is atomic on the single core
+ * targets. No call and no interrupt lock, so it is safe in an ISR. */
+#define PUBLISH(x, v) \
+    do { \
+        __asm__ volatile ("" ::: "memory"); \
+        *(volatile unsigned int *) &(x) = (v); \
+    } while (0)
+
+int tsrb_init(tsrb_t *rb, char *buffer, unsigned int bufsize)
+{
+    if (!bufsize || (bufsize & (bufsize - 1))) {
+        return -1;
+    }
+
+    rb->buf = buffer;
+    rb->size = bufsize;
+    rb->reads = 0;
+    rb->writes = 0;
+    return 0;
+}
+
+unsigned int tsrb_avail(tsrb_t *rb)
+{
+    return LOAD(rb->writes) - LOAD(rb->reads);
+}
+
+unsigned int tsrb_free(tsrb_t *rb)
+{
+    return rb->size - tsrb_avail(rb);
+}
+
+int tsrb_add_one(tsrb_t *rb, char c)
+{
+    unsigned int w = rb->writes;
+
+    if (w - LOAD(rb->reads) == rb->size) {
+        return -1;
+    }
+
+    rb->buf[w & (rb->size - 1)] = c;
+    PUBLISH(rb->writes, w + 1);
+    return 0;
+}
+
+unsigned int tsrb_add(tsrb_t *rb, const char *src, unsigned int n)
+{
+    unsigned int w = rb->writes;
+    unsigned int pos = w & (rb->size - 1);
+    unsigned int space = rb->size - (w - LOAD(rb->reads));
+    unsigned int first;
+
+    if (n > space) {
+        n = space;
+    }
+
+    first = rb->size - pos;
+
+    if (first > n) {
+        first = n;
+    }
+
+    memcpy(rb->buf + pos, src, first);
+    memcpy(rb->buf, src + first, n - first);
+    PUBLISH(rb->writes, w + n);
+    return n;
+}
+
+int tsrb_get_one(tsrb_t *rb)
+{
+    unsigned int r = rb->reads;
+    int c;
+
+    if (LOAD(rb->writes) == r) {
+        return -1;
+    }
+
+    c = (unsigned char) rb->buf[r & (rb->size - 1)];
+    PUBLISH(rb->reads, r + 1);
+    return c;
+}
+
+unsigned int tsrb_get(tsrb_t *rb, char *dst, unsigned int n)
+{
+    unsigned int r = rb->reads;
+    unsigned int pos = r & (rb->size - 1);
+    unsigned int avail = LOAD(rb->writes) - r;
+    unsigned int first;
+
+    if (n > avail) {
+        n = avail;
+    }
+
+    first = rb->size - pos;
+
+    if (first > n) {
+        first = n;
+    }
+
+    memcpy(dst, rb->buf + pos, first);
+    memcpy(dst + first, rb->buf, n - first);
+    PUBLISH(rb->reads, r + n);
+    return n;
+}
+
+unsigned int tsrb_peek_read(tsrb_t *rb, char **data)
+{
+    unsigned int r = rb->reads;
+    unsigned int pos = r & (rb->size - 1);
+    unsigned int n = LOAD(rb->writes) - r;
+
+    if (n > rb->size - pos) {
+        n = rb->size - pos;
+    }
+
+    *data = rb->buf + pos;
+    return n;
+}
+
+void tsrb_commit_read(tsrb_t *rb, unsigned int n)
+{
+    PUBLISH(rb->reads, rb->reads + n);
+}
+
+unsigned int tsrb_peek_write(tsrb_t *rb, char **data)
+{
+    unsigned int w = rb->writes;
+    unsigned int pos = w & (rb->size - 1);
+    unsigned int n = rb->size - (w - LOAD(rb->reads));
+
+    if (n > rb->size - pos) {
+        n = rb->size - pos;
+    }
+
+    *data = rb->buf + pos;
+    return n;
+}
+
+void tsrb_commit_write(tsrb_t *rb, unsigned int n)
+{
+    PUBLISH(rb->writes, rb->writes + n);
+}
@@ -0,0 +1,113 @@
+/**
+ * Thread safe ringbuffer header
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup sys_lib
+ * @{
+ * @file   tsrb.h
+ * @brief  Byte ringbuffer for one producer and one consumer
+ *
+ * One side, e.g. an interrupt handler, may write while the other, e.g. a
+ * thread, reads, without disabling interrupts: the writer only ever
+ * advances 'writes', the reader only 'reads', and each side publishes its
+ * counter only after the data it covers has been copied.
+ *
+ * The size is a power of two and both counters run freely, so the fill
+ * level is writes - reads and positions are taken by masking. Bulk
+ * operations copy with at most two memcpy() calls, one on each side of
+ * the wrap.
+ *
+ * Unlike ringbuffer_t a full tsrb does not overwrite old data, what does
+ * not fit is not added.
+ * @}
+ */
+
+#ifndef __TSRB_H
+#define __TSRB_H
+
+typedef struct tsrb {
+    char *buf;
+    unsigned int size;      /**< power of two */
+    unsigned int reads;     /**< bytes ever read, written by the reader */
+    unsigned int writes;    /**< bytes ever written, written by the writer */
+} tsrb_t;
+
+/**
+ * @brief   Initialise rb on buffer
+ *
+ * @return  0 on success, -1 if bufsize is not a power of two
+ */
+int tsrb_init(tsrb_t *rb, char *buffer, unsigned int bufsize);
+
+/**
+ * @brief   Number of bytes which can be read
+ */
+unsigned int tsrb_avail(tsrb_t *rb);
+
+/**
+ * @brief   Number of bytes which can be written
+ */
+unsigned int tsrb_free(tsrb_t *rb);
+
+/**
+ * @brief   Add one byte
+ *
+ * @return  0 on success, -1 if rb is full
+ */
+int tsrb_add_one(tsrb_t *rb, char c);
+
+/**
+ * @brief   Add up to n bytes
+ *
+ * @return  the number of bytes added
+ */
+unsigned int tsrb_add(tsrb_t *rb, const char *src, unsigned int n);
+
+/**
+ * @brief   Remove one byte
+ *
+ * @return  the byte, -1 if rb is empty
+ */
+int tsrb_get_one(tsrb_t *rb);
+
+/**
+ * @brief   Remove up to n bytes
+ *
+ * @return  the number of bytes copied to dst
+ */
+unsigned int tsrb_get(tsrb_t *rb, char *dst, unsigned int n);
+
+/**
+ * @brief   Zero-copy read: the readable bytes up to the wrap
+ *
+ * @param[out] data where they start
+ *
+ * @return  how many there are, release them with tsrb_commit_read()
+ */
+unsigned int tsrb_peek_read(tsrb_t *rb, char **data);
+
+/**
+ * @brief   Release n bytes returned by tsrb_peek_read()
+ */
+void tsrb_commit_read(tsrb_t *rb, unsigned int n);
+
+/**
+ * @brief   Zero-copy write: the free space up to the wrap
+ *
+ * @param[out] data where it starts
+ *
+ * @return  its size, publish what was filled in with tsrb_commit_write()
+ */
+unsigned int tsrb_peek_write(tsrb_t *rb, char **data);
+
+/**
+ * @brief   Make n bytes written to the space from tsrb_peek_write() readable
+ */
+void tsrb_commit_write(tsrb_t *rb, unsigned int n);
+
+#endif /* __TSRB_H */
@@ -48,6 +48,7 @@
 #include "msg.h"
 #include "thread.h"
 #include "transceiver.h"
+#include "vtimer.h"
 
 #include "ccnl-riot-compat.h"
 #include "test_data/text.txt.ccnb.h"
@@ -62,20 +63,23 @@ msg_t msg_buffer_relay[RELAY_MSG_BUFFER_SIZE];
 
 struct ccnl_relay_s theRelay;
 
+// set while ccnl_riot_relay_start() runs, see ccnl_riot_relay_running()
+static volatile int relay_running;
+
 struct timeval *
 ccnl_run_events(void)
 {
     static struct timeval now;
+    struct ccnl_timer_s *t;
     long usec;
 
     rtc_time(&now);
     DEBUGMSG(1, "ccnl_run_events now: %ld:%ld\n", now.tv_sec, now.tv_usec);
 
-    while (eventqueue) {
-        struct ccnl_timer_s *t = eventqueue;
+    while ((t = ccnl_timer_first())) {
         usec = timevaldelta(&(t->timeout), &now);
 
-        if (usec >= 0) {
+        if (usec > 0) {
             DEBUGMSG(1, "ccnl_run_events nothing to do: %ld:%ld\n", now.tv_sec, now.tv_usec);
             now.tv_sec = usec / 1000000;
             now.tv_usec = usec % 1000000;
@@ -83,15 +87,7 @@ ccnl_run_events(void)
         }
 
         DEBUGMSG(1, "ccnl_run_events run event handler: %ld:%ld\n", now.tv_sec, now.tv_usec);
-        if (t->fct) {
-            (t->fct)(t->node, t->intarg);
-        }
-        else if (t->fct2) {
-            (t->fct2)(t->aux1, t->aux2);
-        }
-
-        eventqueue = t->next;
-        ccnl_free(t);
+        ccnl_timer_fire(t);
     }
 
     return NULL;
@@ -145,6 +141,9 @@ void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_entries)
     DEBUGMSG(99, "ccnl_relay_config\n");
 
     relay->max_cache_entries = max_cache_entries;
+    ccnl_cache_init(relay, &CCNL_DEFAULT_CACHE_POLICY);
+    relay->defaultFaceScheduler = ccnl_sched_face_new;
+    relay->defaultInterfaceScheduler = ccnl_sched_interface_new;
 
     if (RIOT_MSG_IDX != relay->ifcount) {
         DEBUGMSG(1, "sorry, idx did not match: riot msg device\n");
@@ -163,6 +162,8 @@ void ccnl_relay_config(struct ccnl_relay_s *relay, int max_cache_entries)
         if (relay->defaultInterfaceScheduler) {
             i->sched = relay->defaultInterfaceScheduler(relay,
                        ccnl_interface_CTS);
+            // local IPC, no need to pace it
+            ccnl_sched_set_rate(i->sched, 0, 0);
         }
     }
     else {
@@ -234,13 +235,18 @@ void ccnl_populate_cache(struct ccnl_relay_s *ccnl, unsigned char *buf, int data
             goto Done;
         }
 
-        ccnl_content_add2cache(ccnl, c);
+        // static content is never handed to the replacement policy
         c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+
+        if (!ccnl_content_add2cache(ccnl, c)) {
+            free_content(c);
+            goto Done;
+        }
     Done:
         free_prefix(prefix);
-        ccnl_free(pkt);
-        ccnl_free(nonce);
-        ccnl_free(ppkd);
+        ccnl_buf_free(pkt);
+        ccnl_buf_free(nonce);
+        ccnl_buf_free(ppkd);
     }
     else {
         DEBUGMSG(6, "  not a content object\n");
@@ -308,11 +314,24 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
     msg_t in;
     radio_packet_t *p;
     riot_ccnl_msg_t *m;
+    struct ccnl_cache_policy_s *policy;
+    vtimer_t event_vt;
+
+    memset(&event_vt, 0, sizeof(event_vt));
 
     while (!ccnl->halt_flag) {
+        struct timeval *timeout = ccnl_run_events();
+
+        // wake up for the next timer even if no packet arrives meanwhile
+        vtimer_remove(&event_vt);
+
+        if (timeout) {
+            vtimer_set_msg(&event_vt, timex_set(timeout->tv_sec, timeout->tv_usec),
+                           thread_getpid(), NULL);
+        }
+
         DEBUGMSG(1, "waiting for incomming msg\n");
         msg_receive(&in);
-        struct timeval *timeout = ccnl_run_events();
 
         switch (in.type) {
             case PKT_PENDING:
@@ -332,6 +351,7 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                 break;
 
             case (CCNL_RIOT_MSG):
+            case (CCNL_RIOT_MSG_OWNED):
                 m = (riot_ccnl_msg_t *) in.content.ptr;
                 DEBUGMSG(1, "%s Packet waiting\n", riot_ccnl_event_to_string(in.type));
                 DEBUGMSG(1, "\tLength:\t%u\n", m->size);
@@ -339,6 +359,11 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
 
                 ccnl_core_RX(ccnl, RIOT_MSG_IDX, (unsigned char *) m->payload, m->size,
                              in.sender_pid);
+
+                if (in.type == CCNL_RIOT_MSG_OWNED) {
+                    ccnl_free(m);
+                }
+
                 break;
 
             case (CCNL_RIOT_HALT):
@@ -348,6 +373,24 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
 
                 ccnl->halt_flag = 1;
                 break;
+
+            case (CCNL_RIOT_PRINT_STAT):
+                // the tables belong to this thread, so they are printed here
+                ccnl_cache_print_stats(ccnl);
+                ccnl_strategy_print_stats(ccnl);
+                break;
+
+            case (CCNL_RIOT_CACHE_POLICY):
+                policy = ccnl_cache_policy_by_name(in.content.ptr);
+
+                if (!policy) {
+                    DEBUGMSG(1, "unknown cache policy '%s'\n", in.content.ptr);
+                    break;
+                }
+
+                // the content store is kept, it is requeued for the new policy
+                ccnl_cache_init(ccnl, policy);
+                break;
 #if RIOT_CCNL_POPULATE
             case (CCNL_RIOT_POPULATE):
                 DEBUGMSG(1, "%s Packet waiting\n", riot_ccnl_event_to_string(in.type));
@@ -357,6 +400,10 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
                 handle_populate_cache();
                 break;
 #endif
+            case MSG_TIMER:
+                // timers run at the top of the loop
+                break;
+
             default:
                 DEBUGMSG(1, "%s Packet waiting\n", riot_ccnl_event_to_string(in.type));
                 DEBUGMSG(1, "\tSrc:\t%u\n", in.sender_pid);
@@ -376,6 +423,7 @@ int ccnl_io_loop(struct ccnl_relay_s *ccnl)
 void ccnl_riot_relay_start(int max_cache_entries)
 {
     struct timeval now;
+    relay_running = 1;
     theRelay.startup_time = rtc_time(&now);
 
     DEBUGMSG(1, "This is ccn-lite-relay, starting at %lu:%lu\n", now.tv_sec, now.tv_usec);
@@ -388,11 +436,16 @@ void ccnl_riot_relay_start(int max_cache_entries)
     ccnl_io_loop(&theRelay);
     DEBUGMSG(1, "ioloop stopped\n");
 
-    while (eventqueue) {
-        ccnl_rem_timer(eventqueue);
-    }
+    ccnl_rem_all_timers();
 
     ccnl_core_cleanup(&theRelay);
+    ccnl_buf_slab_cleanup();
+    relay_running = 0;
+}
+
+int ccnl_riot_relay_running(void)
+{
+    return relay_running;
 }
 
 // eof
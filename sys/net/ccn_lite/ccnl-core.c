@@ -23,6 +23,8 @@
 
 #define CCNL_VERSION "2013-07-27"
 
+#define USE_CCNxDIGEST
+
 #include <string.h>
 #include <stdio.h>
 
@@ -32,6 +34,7 @@
 #include "ccnx.h"
 #include "ccnl-ext.h"
 #include "ccnl-platform.h"
+#include "hashes.h"
 
 #include "ccnl-includes.h"
 
@@ -66,7 +69,17 @@ void free_4ptr_list(void *a, void *b, void *c, void *d)
 
 void free_prefix(struct ccnl_prefix_s *p)
 {
-    if (p) {
+    if (!p) {
+        return;
+    }
+
+    ccnl_buf_free(p->buf);
+
+    // parsed prefixes carry comp and complen in the same allocation
+    if (p->comp == (unsigned char **)(p + 1)) {
+        free_2ptr_list(p->path, p);
+    }
+    else {
         free_4ptr_list(p->path, p->comp, p->complen, p);
     }
 }
@@ -74,22 +87,44 @@ void free_prefix(struct ccnl_prefix_s *p)
 void free_content(struct ccnl_content_s *c)
 {
     free_prefix(c->name);
-    free_2ptr_list(c->pkt, c);
+    ccnl_buf_free(c->pkt);
+    ccnl_buf_free(c->ppkd);
+    free_2ptr_list(c->nameidx, c);
 }
 
 // ----------------------------------------------------------------------
 // datastructure support functions
 
+// buffers of the two slab size classes are not freed but kept on a free
+// list, up to CCNL_BUF_SLAB_KEEP per class
+static const int buf_slabsize[2] = {CCNL_BUF_SLAB_SMALL, CCNL_BUF_SLAB_LARGE};
+static struct ccnl_buf_s *buf_slab[2];
+static int buf_slabcnt[2];
+
 struct ccnl_buf_s *
 ccnl_buf_new(void *data, int len)
 {
-    struct ccnl_buf_s *b = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*b) + len);
+    struct ccnl_buf_s *b;
+    int slab = len <= CCNL_BUF_SLAB_SMALL ? 0 :
+               len <= CCNL_BUF_SLAB_LARGE ? 1 : -1;
 
-    if (!b) {
-        return NULL;
+    if (slab >= 0 && buf_slab[slab]) {
+        b = buf_slab[slab];
+        buf_slab[slab] = b->next;
+        buf_slabcnt[slab]--;
+    }
+    else {
+        b = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*b) +
+                                              (slab >= 0 ? buf_slabsize[slab] : len));
+
+        if (!b) {
+            return NULL;
+        }
     }
 
     b->next = NULL;
+    b->refcnt = 1;
+    b->slab = slab;
     b->datalen = len;
 
     if (data) {
@@ -99,9 +134,45 @@ ccnl_buf_new(void *data, int len)
     return b;
 }
 
-struct ccnl_buf_s *buf_dup(struct ccnl_buf_s *B)
+struct ccnl_buf_s *
+ccnl_buf_ref(struct ccnl_buf_s *b)
 {
-    return (B) ? ccnl_buf_new(B->data, B->datalen) : NULL;
+    if (b) {
+        b->refcnt++;
+    }
+
+    return b;
+}
+
+void ccnl_buf_free(struct ccnl_buf_s *b)
+{
+    if (!b || --b->refcnt > 0) {
+        return;
+    }
+
+    if (b->slab >= 0 && buf_slabcnt[b->slab] < CCNL_BUF_SLAB_KEEP) {
+        b->next = buf_slab[b->slab];
+        buf_slab[b->slab] = b;
+        buf_slabcnt[b->slab]++;
+    }
+    else {
+        ccnl_free(b);
+    }
+}
+
+void ccnl_buf_slab_cleanup(void)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        while (buf_slab[i]) {
+            struct ccnl_buf_s *b = buf_slab[i];
+            buf_slab[i] = b->next;
+            ccnl_free(b);
+        }
+
+        buf_slabcnt[i] = 0;
+    }
 }
 
 int buf_equal(struct ccnl_buf_s *X, struct ccnl_buf_s *Y)
@@ -124,7 +195,7 @@ int ccnl_prefix_cmp(struct ccnl_prefix_s *name, unsigned char *md,
 
     for (i = 0; i < nlen && i < p->compcnt; i++) {
         comp = i < name->compcnt ? name->comp[i] : md;
-        clen = i < name->compcnt ? name->complen[i] : 32; // SHA256_DIGEST_LEN
+        clen = i < name->compcnt ? name->complen[i] : SHA256_DIGEST_LENGTH;
 
         if (clen != p->complen[i] || memcmp(comp, p->comp[i], p->complen[i])) {
             rc = mode == CMP_EXACT ? -1 : i;
@@ -141,6 +212,51 @@ done:
     return rc;
 }
 
+static void ccnl_alist_unlink(struct ccnl_alist_s *l, struct ccnl_alink_s *a)
+{
+    if (!a->obj) {
+        return;
+    }
+
+    if (a->prev) {
+        a->prev->next = a->next;
+    }
+    else {
+        l->head = a->next;
+    }
+
+    if (a->next) {
+        a->next->prev = a->prev;
+    }
+    else {
+        l->tail = a->prev;
+    }
+
+    a->next = a->prev = NULL;
+    a->obj = NULL;
+}
+
+// (re)schedule obj: callers keep a list sorted by appending with deadlines
+// which never decrease, see struct ccnl_alink_s
+static void ccnl_alist_append(struct ccnl_alist_s *l, struct ccnl_alink_s *a,
+                              void *obj, int deadline)
+{
+    ccnl_alist_unlink(l, a);
+    a->obj = obj;
+    a->deadline = deadline;
+    a->next = NULL;
+    a->prev = l->tail;
+
+    if (l->tail) {
+        l->tail->next = a;
+    }
+    else {
+        l->head = a;
+    }
+
+    l->tail = a;
+}
+
 // ----------------------------------------------------------------------
 // ccnb parsing support
 
@@ -214,21 +330,18 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
     struct ccnl_buf_s *buf, *n = 0, *pub = 0;
     DEBUGMSG(99, "ccnl_extract_prefix\n");
 
-    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    // one allocation: the components are views into the packet buffer
+    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s)
+            + (CCNL_MAX_NAME_COMP + 1) * sizeof(unsigned char *)
+            + CCNL_MAX_NAME_COMP * sizeof(int));
 
     if (!p) {
         puts("can't get more memory from malloc, dropping ccn msg...");
         return NULL;
     }
 
-    p->comp = (unsigned char **) ccnl_malloc(
-                  CCNL_MAX_NAME_COMP * sizeof(unsigned char **));
-    p->complen = (int *) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(int));
-
-    if (!p->comp || !p->complen) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-        goto Bail;
-    }
+    p->comp = (unsigned char **)(p + 1);
+    p->complen = (int *)(p->comp + CCNL_MAX_NAME_COMP + 1);
 
     while (dehead(data, datalen, &num, &typ) == 0) {
         if (num == 0 && typ == 0) {
@@ -319,8 +432,26 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
         }
     }
 
+    buf = ccnl_buf_new(start, *data - start);
+
+    if (!buf) {
+        puts("can't get more memory from malloc, dropping ccn msg...");
+        goto Bail;
+    }
+
+    // carefully rebase ptrs to new buf because of 64bit pointers:
+    if (content) {
+        *content = buf->data + (*content - start);
+    }
+
+    for (num = 0; num < p->compcnt; num++) {
+        p->comp[num] = buf->data + (p->comp[num] - start);
+    }
+
+    p->comp[p->compcnt] = NULL;
+    p->buf = ccnl_buf_ref(buf);
+
     if (prefix) {
-        p->comp[p->compcnt] = NULL;
         *prefix = p;
     }
     else {
@@ -331,35 +462,21 @@ ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
         *nonce = n;
     }
     else {
-        ccnl_free(n);
+        ccnl_buf_free(n);
     }
 
     if (ppkd) {
         *ppkd = pub;
     }
     else {
-        ccnl_free(pub);
-    }
-
-    buf = ccnl_buf_new(start, *data - start);
-
-    if (!buf) {
-        puts("can't get more memory from malloc, dropping ccn msg...");
-    }
-
-    // carefully rebase ptrs to new buf because of 64bit pointers:
-    if (content) {
-        *content = buf->data + (*content - start);
-    }
-
-    for (num = 0; num < p->compcnt; num++) {
-        p->comp[num] = buf->data + (p->comp[num] - start);
+        ccnl_buf_free(pub);
     }
 
     return buf;
 Bail:
     free_prefix(p);
-    free_2ptr_list(n, pub);
+    ccnl_buf_free(n);
+    ccnl_buf_free(pub);
     return NULL;
 }
 
@@ -388,6 +505,8 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
         if (ifndx == f->ifndx && (f->faceid == sender_id)) {
             DEBUGMSG(1, "face found! ifidx=%d sender_id=%d faceid=%d\n", ifndx, sender_id, f->faceid);
             f->last_used = CCNL_NOW();
+            ccnl_alist_append(&ccnl->face_ageing, &f->ageidx, f,
+                              f->last_used + CCNL_FACE_TIMEOUT);
             return f;
         }
     }
@@ -450,6 +569,8 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id
 #endif
 
     f->last_used = CCNL_NOW();
+    ccnl_alist_append(&ccnl->face_ageing, &f->ageidx, f,
+                      f->last_used + CCNL_FACE_TIMEOUT);
     DBL_LINKED_LIST_ADD(ccnl->faces, f);
 
     return f;
@@ -460,7 +581,6 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
     struct ccnl_face_s *f2;
     struct ccnl_interest_s *pit;
-    struct ccnl_forward_s **ppfwd;
     DEBUGMSG(1, "ccnl_face_remove relay=%p face=%p\n", (void *) ccnl, (void *) f);
 
     ccnl_sched_destroy(f->sched);
@@ -492,25 +612,16 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
         }
     }
 
-    for (ppfwd = &ccnl->fib; *ppfwd;) {
-        if ((*ppfwd)->face == f) {
-            struct ccnl_forward_s *pfwd = *ppfwd;
-            free_prefix(pfwd->prefix);
-            *ppfwd = pfwd->next;
-            ccnl_free(pfwd);
-        }
-        else {
-            ppfwd = &(*ppfwd)->next;
-        }
-    }
+    ccnl_fib_remove_face(ccnl, f);
 
-    while (f->outq) {
-        struct ccnl_buf_s *tmp = f->outq->next;
-        ccnl_free(f->outq);
-        f->outq = tmp;
+    while (f->outqlen > 0) {
+        ccnl_buf_free(f->outq[f->outqfront]);
+        f->outqfront = (f->outqfront + 1) % CCNL_MAX_FACE_QLEN;
+        f->outqlen--;
     }
 
     f2 = f->next;
+    ccnl_alist_unlink(&ccnl->face_ageing, &f->ageidx);
     DBL_LINKED_LIST_REMOVE(ccnl->faces, f);
     ccnl_free(f);
     return f2;
@@ -526,7 +637,7 @@ void ccnl_interface_cleanup(struct ccnl_if_s *i)
     for (j = 0; j < i->qlen; j++) {
         struct ccnl_txrequest_s *r = i->queue
                                      + (i->qfront + j) % CCNL_MAX_IF_QLEN;
-        ccnl_free(r->buf);
+        ccnl_buf_free(r->buf);
     }
 }
 
@@ -551,7 +662,7 @@ void ccnl_interface_CTS(void *aux1, void *aux2)
     ifc->qlen--;
 
     ccnl_ll_TX(ccnl, ifc, &req.dst, req.buf);
-    ccnl_free(req.buf);
+    ccnl_buf_free(req.buf);
 }
 
 void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
@@ -564,7 +675,8 @@ void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
 
     if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
         DEBUGMSG(2, "  DROPPING buf=%p\n", (void *) buf);
-        ccnl_free(buf);
+        ifc->qstats.dropped++;
+        ccnl_buf_free(buf);
         return;
     }
 
@@ -574,8 +686,14 @@ void ccnl_interface_enqueue(void (tx_done)(void *, int, int),
     r->txdone = tx_done;
     r->txdone_face = f;
     ifc->qlen++;
+    ifc->qstats.enqueued++;
 
-    ccnl_interface_CTS(ccnl, ifc);
+    if (ifc->sched) {
+        ccnl_sched_RTS(ifc->sched, 1, buf->datalen, ccnl, ifc);
+    }
+    else {
+        ccnl_interface_CTS(ccnl, ifc);
+    }
 }
 
 struct ccnl_buf_s *
@@ -587,18 +705,13 @@ ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     DEBUGMSG(20, "ccnl_face_dequeue face=%p (id=%d.%d)\n", (void *) f, ccnl->id,
              f->faceid);
 
-    if (!f->outq) {
+    if (f->outqlen <= 0) {
         return NULL;
     }
 
-    pkt = f->outq;
-    f->outq = pkt->next;
-
-    if (!pkt->next) {
-        f->outqend = NULL;
-    }
-
-    pkt->next = NULL;
+    pkt = f->outq[f->outqfront];
+    f->outqfront = (f->outqfront + 1) % CCNL_MAX_FACE_QLEN;
+    f->outqlen--;
     return pkt;
 }
 
@@ -645,66 +758,171 @@ void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                       struct ccnl_buf_s *buf)
 {
-    struct ccnl_buf_s *msg;
+    uint32_t h;
+    int k, slot;
+
+    if (!buf) {
+        return -1;
+    }
+
     DEBUGMSG(20, "ccnl_face_enqueue face=%p (id=%d.%d) buf=%p len=%d\n",
              (void *) to, ccnl->id, to->faceid, (void *) buf, buf->datalen);
 
-    for (msg = to->outq; msg; msg = msg->next) // already in the queue?
-        if (buf_equal(msg, buf)) {
+    h = ccnl_hash_update(CCNL_HASH_INIT, buf->data, buf->datalen);
+
+    for (k = 0; k < to->outqlen; k++) { // already in the queue?
+        slot = (to->outqfront + k) % CCNL_MAX_FACE_QLEN;
+
+        if (to->outqhash[slot] == h && buf_equal(to->outq[slot], buf)) {
             DEBUGMSG(31, "    not enqueued because already there\n");
-            ccnl_free(buf);
+            to->qstats.dups++;
+            ccnl_buf_free(buf);
             return -1;
         }
+    }
+
+    if (to->outqlen >= CCNL_MAX_FACE_QLEN) {
+        DEBUGMSG(2, "  face queue full, DROPPING buf=%p\n", (void *) buf);
+        to->qstats.dropped++;
+        ccnl_buf_free(buf);
+        return -1;
+    }
 
-    buf->next = NULL;
+    slot = (to->outqfront + to->outqlen) % CCNL_MAX_FACE_QLEN;
+    to->outq[slot] = buf;
+    to->outqhash[slot] = h;
+    to->outqlen++;
+    to->qstats.enqueued++;
 
-    if (to->outqend) {
-        to->outqend->next = buf;
+    if (to->sched) {
+        ccnl_sched_RTS(to->sched, 1, buf->datalen, ccnl, to);
     }
     else {
-        to->outq = buf;
+        ccnl_face_CTS(ccnl, to);
     }
 
-    to->outqend = buf;
-    ccnl_face_CTS(ccnl, to);
     return 0;
 }
 
 // ----------------------------------------------------------------------
 // handling of interest messages
 
+static uint32_t nonce_hash_fnv(const uint8_t *buf, size_t len)
+{
+    return ccnl_hash_update(CCNL_HASH_INIT, (unsigned char *) buf, len);
+}
+
+static hashfp_t nonce_hashes[CCNL_NONCE_BLOOM_HASHES] = {
+    nonce_hash_fnv, sdbm_hash, djb2_hash, one_at_a_time_hash
+};
+
+static void ccnl_nonce_rotate(struct ccnl_nonce_filter_s *nf, int now)
+{
+    nf->cur = !nf->cur;
+    bloom_init(nf->gen + nf->cur, CCNL_NONCE_BLOOM_BITS, nf->bits[nf->cur],
+               nonce_hashes, CCNL_NONCE_BLOOM_HASHES);
+    nf->cnt = 0;
+    nf->started = now;
+    nf->stats.rotations++;
+}
+
 int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
                               struct ccnl_buf_s *nonce)
 {
-    struct ccnl_buf_s *n, *n2 = 0;
-    int i;
+    struct ccnl_nonce_filter_s *nf = &ccnl->nonces;
+    int now = CCNL_NOW();
     DEBUGMSG(99, "ccnl_nonce_find_or_append\n");
 
-    for (n = ccnl->nonces, i = 0; n; n = n->next, i++) {
-        if (buf_equal(n, nonce)) {
-            return -1;
-        }
-
-        if (n->next) {
-            n2 = n;
-        }
+    if (!nf->gen[0].a) { // first use
+        bloom_init(nf->gen, CCNL_NONCE_BLOOM_BITS, nf->bits[0],
+                   nonce_hashes, CCNL_NONCE_BLOOM_HASHES);
+        bloom_init(nf->gen + 1, CCNL_NONCE_BLOOM_BITS, nf->bits[1],
+                   nonce_hashes, CCNL_NONCE_BLOOM_HASHES);
+        nf->started = now;
     }
 
-    n = ccnl_buf_new(nonce->data, nonce->datalen);
+    nf->stats.checks++;
 
-    if (n) {
-        n->next = ccnl->nonces;
-        ccnl->nonces = n;
+    if (bloom_check(nf->gen + nf->cur, nonce->data, nonce->datalen)
+        || bloom_check(nf->gen + !nf->cur, nonce->data, nonce->datalen)) {
+        nf->stats.dups++;
+        return -1;
+    }
 
-        if (i >= CCNL_MAX_NONCES && n2) {
-            ccnl_free(n2->next);
-            n2->next = 0;
-        }
+    if (nf->cnt >= CCNL_MAX_NONCES || now - nf->started >= CCNL_NONCE_TIMEOUT) {
+        ccnl_nonce_rotate(nf, now);
     }
 
+    bloom_add(nf->gen + nf->cur, nonce->data, nonce->datalen);
+    nf->cnt++;
     return 0;
 }
 
+// probability (in ppm) that a new nonce hits all set bits of generation g
+static unsigned long ccnl_nonce_fp_ppm(struct bloom_t *g)
+{
+    unsigned long set = 0, fill, ppm = 1000000;
+    size_t i;
+
+    if (!g->a) {
+        return 0;
+    }
+
+    for (i = 0; i < g->m; i++) {
+        set += (g->a[i / 8] >> (i % 8)) & 1;
+    }
+
+    fill = (unsigned long)((1000000ULL * set) / g->m);
+
+    for (i = 0; i < g->k; i++) {
+        ppm = (unsigned long)(((unsigned long long) ppm * fill) / 1000000);
+    }
+
+    return ppm;
+}
+
+void ccnl_nonce_print_stats(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_nonce_filter_s *nf = &ccnl->nonces;
+    unsigned long fp0 = ccnl_nonce_fp_ppm(nf->gen + nf->cur);
+    unsigned long fp1 = ccnl_nonce_fp_ppm(nf->gen + !nf->cur);
+
+    printf("nonce filter: %d/%d in current generation, %d bits, %d hashes\n",
+           nf->cnt, CCNL_MAX_NONCES, CCNL_NONCE_BLOOM_BITS,
+           CCNL_NONCE_BLOOM_HASHES);
+    printf("  checks=%lu dups=%lu rotations=%lu\n", nf->stats.checks,
+           nf->stats.dups, nf->stats.rotations);
+    // a lookup is a false positive if it hits either generation
+    printf("  false positive rate now: %lu ppm (current %lu, previous %lu)\n",
+           fp0 + fp1 - (unsigned long)(((unsigned long long) fp0 * fp1) / 1000000),
+           fp0, fp1);
+}
+
+// CONFORM: "A node MUST retransmit Interest Messages periodically for
+// pending PIT entries." CCNL: after CCNL_INTEREST_RETRANSMIT seconds,
+// doubling the interval with each retry
+static void ccnl_interest_schedule_retransmit(struct ccnl_relay_s *ccnl,
+        struct ccnl_interest_s *i, int now)
+{
+    int deadline;
+
+    if (i->retries >= CCNL_MAX_INTEREST_RETRANSMIT) {
+        return;
+    }
+
+    deadline = now + (CCNL_INTEREST_RETRANSMIT << i->retries);
+    ccnl_alist_append(ccnl->retransmit + deadline % CCNL_RETRANSMIT_SLOTS,
+                      &i->rtxidx, i, deadline);
+}
+
+// only names whose last component has the length of a SHA256 can match
+// a content object through its implicit digest
+static inline int ccnl_prefix_has_digest(struct ccnl_prefix_s *p)
+{
+    return p->compcnt > 0
+           && p->complen[p->compcnt - 1] == SHA256_DIGEST_LENGTH;
+}
+
 struct ccnl_interest_s *
 ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                   struct ccnl_buf_s **pkt, struct ccnl_prefix_s **prefix, int minsuffix,
@@ -729,10 +947,47 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     i->minsuffix = minsuffix;
     i->maxsuffix = maxsuffix;
     i->last_used = CCNL_NOW();
+    ccnl_alist_append(&ccnl->pit_ageing, &i->ageidx, i,
+                      i->last_used + CCNL_INTEREST_TIMEOUT);
+    ccnl_interest_schedule_retransmit(ccnl, i, i->last_used);
+    i->pitidx.hash = ccnl_prefix_hash(i->prefix, i->prefix->compcnt);
+    i->pitidx.obj = i;
+    ccnl_htab_add(&ccnl->pit_names, &i->pitidx);
     DBL_LINKED_LIST_ADD(ccnl->pit, i);
+
+    if (ccnl_prefix_has_digest(i->prefix)) {
+        ccnl->pit_digestcnt++;
+    }
+
     return i;
 }
 
+// find the PIT entry for exactly this interest (name and selectors). The
+// index is keyed on the name only: content has to find all interests
+// below its name regardless of their selectors, see
+// ccnl_content_serve_pending(). Selector variants share one chain.
+struct ccnl_interest_s *
+ccnl_interest_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                   int minsuffix, int maxsuffix, struct ccnl_buf_s *ppkd)
+{
+    struct ccnl_hlink_s *l;
+    struct ccnl_interest_s *i;
+
+    for (l = ccnl_htab_lookup(&ccnl->pit_names,
+                              ccnl_prefix_hash(p, p->compcnt));
+         l; l = ccnl_htab_next(l)) {
+        i = (struct ccnl_interest_s *) l->obj;
+
+        if (!ccnl_prefix_cmp(i->prefix, NULL, p, CMP_EXACT)
+            && i->minsuffix == minsuffix && i->maxsuffix == maxsuffix
+            && ((!ppkd && !i->ppkd) || buf_equal(ppkd, i->ppkd))) {
+            return i;
+        }
+    }
+
+    return NULL;
+}
+
 int ccnl_interest_append_pending(struct ccnl_interest_s *i,
                                  struct ccnl_face_s *from)
 {
@@ -773,7 +1028,8 @@ int ccnl_interest_append_pending(struct ccnl_interest_s *i,
 void ccnl_interest_propagate(struct ccnl_relay_s *ccnl,
                              struct ccnl_interest_s *i)
 {
-    struct ccnl_forward_s *fwd;
+    struct ccnl_fib_node_s *n;
+    struct ccnl_strategy_s *s;
     DEBUGMSG(99, "ccnl_interest_propagate\n");
 
     ccnl_print_stats(ccnl, STAT_SND_I); // log_send_i
@@ -782,30 +1038,22 @@ void ccnl_interest_propagate(struct ccnl_relay_s *ccnl,
 
     // CONFORM: "A node MUST implement some strategy rule, even if it is only to
     // transmit an Interest Message on all listed dest faces in sequence."
-    // CCNL strategy: we forward on all FWD entries with a prefix match
-    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
-        int rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->prefix, CMP_LONGEST);
-        DEBUGMSG(40, "  ccnl_interest_propagate, rc=%d/%d\n", rc,
-                 fwd->prefix->compcnt);
+    // CCNL strategy: the strategy of the interest's name picks among the
+    // next hops of the longest matching prefix, see ccnl-ext-strategy.c.
+    // Shorter prefixes are only tried if the longest match has no usable
+    // next hop (e.g. it points back to the origin of the interest).
+    s = ccnl_fib_strategy(ccnl, i->prefix);
 
-        if (rc < fwd->prefix->compcnt) {
-            continue;
-        }
-
-        DEBUGMSG(40, "  ccnl_interest_propagate, fwd==%p\n", (void *) fwd);
-
-        // suppress forwarding to origin of interest, except wireless
-        if (!i->from || fwd->face != i->from
-            || (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
-            ccnl_face_enqueue(ccnl, fwd->face, buf_dup(i->pkt));
-            hits++;
-        }
+    for (n = ccnl_fib_lookup(ccnl, i->prefix); n && !hits;
+         n = ccnl_fib_parent(n)) {
+        DEBUGMSG(40, "  ccnl_interest_propagate, strategy=%s\n", s->name);
+        hits = s->forward(ccnl, i, n);
     }
 
     if (hits == 0) {
         DEBUGMSG(1, "no hits in the fib...find riot transceiver face\n");
         struct ccnl_face_s *face = ccnl_get_face_or_create(ccnl, RIOT_TRANS_IDX, 0 /* broadcast */);
-        ccnl_face_enqueue(ccnl, face, buf_dup(i->pkt));
+        ccnl_face_enqueue(ccnl, face, ccnl_buf_ref(i->pkt));
     }
 
     return;
@@ -823,10 +1071,22 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
         i->pending = tmp;
     }
 
+    ccnl_strategy_release(ccnl, i);
     i2 = i->next;
+    ccnl_alist_unlink(&ccnl->pit_ageing, &i->ageidx);
+    ccnl_alist_unlink(ccnl->retransmit +
+                      i->rtxidx.deadline % CCNL_RETRANSMIT_SLOTS, &i->rtxidx);
+    ccnl_htab_remove(&ccnl->pit_names, &i->pitidx);
     DBL_LINKED_LIST_REMOVE(ccnl->pit, i);
+
+    if (ccnl_prefix_has_digest(i->prefix)) {
+        ccnl->pit_digestcnt--;
+    }
+
     free_prefix(i->prefix);
-    free_3ptr_list(i->ppkd, i->pkt, i);
+    ccnl_buf_free(i->ppkd);
+    ccnl_buf_free(i->pkt);
+    ccnl_free(i);
     return i2;
 }
 
@@ -856,12 +1116,28 @@ int ccnl_i_prefixof_c(struct ccnl_prefix_s *prefix, struct ccnl_buf_s *ppkd,
     md = NULL;
 
     if ((prefix->compcnt - c->name->compcnt) == 1) {
-        md = compute_ccnx_digest(c->pkt);
+        md = compute_ccnx_digest(c);
     }
 
     return ccnl_prefix_cmp(c->name, md, prefix, CMP_MATCH) == prefix->compcnt;
 }
 
+// the implicit digest is the SHA256 over the full datagram. Computing it
+// is expensive, so every content object does so at most once.
+unsigned char *ccnl_content_digest(struct ccnl_content_s *c)
+{
+    SHA256_CTX ctx;
+
+    if (!(c->flags & CCNL_CONTENT_FLAGS_DIGEST)) {
+        SHA256_Init(&ctx);
+        SHA256_Update(&ctx, c->pkt->data, c->pkt->datalen);
+        SHA256_Final(c->digest, &ctx);
+        c->flags |= CCNL_CONTENT_FLAGS_DIGEST;
+    }
+
+    return c->digest;
+}
+
 struct ccnl_content_s *
 ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
                  struct ccnl_prefix_s **prefix, struct ccnl_buf_s **ppkd,
@@ -896,12 +1172,135 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
     return c;
 }
 
+// ----------------------------------------------------------------------
+// content store index: every cached content is linked into cs_names once
+// per name component, under the hash of its name truncated to that many
+// components. An interest with n components thus finds all candidate
+// content objects in the chain of its own prefix hash; the full name is
+// the entry with n == name->compcnt. cs_pkts detects duplicate datagrams.
+
+static uint32_t ccnl_pkt_hash(struct ccnl_buf_s *pkt)
+{
+    return ccnl_hash_update(CCNL_HASH_INIT, pkt->data, pkt->datalen);
+}
+
+static int ccnl_content_index(struct ccnl_relay_s *ccnl,
+                              struct ccnl_content_s *c)
+{
+    uint32_t h = CCNL_HASH_INIT;
+    int i;
+
+    if (c->name->compcnt > 0) {
+        c->nameidx = (struct ccnl_hlink_s *) ccnl_calloc(c->name->compcnt,
+                     sizeof(struct ccnl_hlink_s));
+
+        if (!c->nameidx) {
+            return -1;
+        }
+    }
+
+    for (i = 0; i < c->name->compcnt; i++) {
+        h = ccnl_hash_component(h, c->name->comp[i], c->name->complen[i]);
+        c->nameidx[i].hash = h;
+        c->nameidx[i].obj = c;
+        ccnl_htab_add(&ccnl->cs_names, c->nameidx + i);
+    }
+
+    c->pktidx.hash = ccnl_pkt_hash(c->pkt);
+    c->pktidx.obj = c;
+    ccnl_htab_add(&ccnl->cs_pkts, &c->pktidx);
+    return 0;
+}
+
+static void ccnl_content_unindex(struct ccnl_relay_s *ccnl,
+                                 struct ccnl_content_s *c)
+{
+    int i;
+
+    if (c->nameidx) {
+        for (i = 0; i < c->name->compcnt; i++) {
+            ccnl_htab_remove(&ccnl->cs_names, c->nameidx + i);
+        }
+
+        ccnl_free(c->nameidx);
+        c->nameidx = NULL;
+    }
+
+    ccnl_htab_remove(&ccnl->cs_pkts, &c->pktidx);
+}
+
+// find a cached content object matching the given interest
+struct ccnl_content_s *
+ccnl_content_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                    struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix)
+{
+    struct ccnl_hlink_s *l;
+    struct ccnl_content_s *c;
+    uint32_t h;
+
+    if (p->compcnt == 0) { // the empty name matches everything
+        for (c = ccnl->contents; c; c = c->next)
+            if (ccnl_i_prefixof_c(p, ppkd, minsuffix, maxsuffix, c)) {
+                return c;
+            }
+
+        return NULL;
+    }
+
+    h = ccnl_prefix_hash(p, p->compcnt - 1);
+
+    // implicit digest: the interest's last component may be the digest
+    // of a content whose full name is one component shorter
+    if (p->complen[p->compcnt - 1] == SHA256_DIGEST_LENGTH) {
+        for (l = ccnl_htab_lookup(&ccnl->cs_names, h); l; l = ccnl_htab_next(l)) {
+            c = (struct ccnl_content_s *) l->obj;
+
+            if (c->name->compcnt == p->compcnt - 1
+                && ccnl_i_prefixof_c(p, ppkd, minsuffix, maxsuffix, c)) {
+                return c;
+            }
+        }
+    }
+
+    h = ccnl_hash_component(h, p->comp[p->compcnt - 1],
+                            p->complen[p->compcnt - 1]);
+
+    for (l = ccnl_htab_lookup(&ccnl->cs_names, h); l; l = ccnl_htab_next(l)) {
+        c = (struct ccnl_content_s *) l->obj;
+
+        if (ccnl_i_prefixof_c(p, ppkd, minsuffix, maxsuffix, c)) {
+            return c;
+        }
+    }
+
+    return NULL;
+}
+
+// find a cached content object carrying exactly the given datagram
+struct ccnl_content_s *
+ccnl_content_find_dup(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *pkt)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = ccnl_htab_lookup(&ccnl->cs_pkts, ccnl_pkt_hash(pkt)); l;
+         l = ccnl_htab_next(l)) {
+        if (buf_equal(((struct ccnl_content_s *) l->obj)->pkt, pkt)) {
+            return (struct ccnl_content_s *) l->obj;
+        }
+    }
+
+    return NULL;
+}
+
 struct ccnl_content_s *
 ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
     struct ccnl_content_s *c2;
     DEBUGMSG(99, "ccnl_content_remove\n");
 
+    ccnl_content_unindex(ccnl, c);
+    ccnl_cache_remove(ccnl, c);
+    ccnl_alist_unlink(&ccnl->content_ageing, &c->ageidx);
     c2 = c->next;
     DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
     free_content(c);
@@ -921,21 +1320,12 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     }
 
     while (ccnl->max_cache_entries <= ccnl->contentcnt) {
-        DEBUGMSG(1, "  remove oldest content...\n");
-        struct ccnl_content_s *c2, *oldest = NULL;
-        int age = 0;
-
-        for (c2 = ccnl->contents; c2; c2 = c2->next) {
-            if (!(c2->flags & CCNL_CONTENT_FLAGS_STATIC)
-                && ((age == 0) || c2->last_used < age)) {
-                age = c2->last_used;
-                oldest = c2;
-            }
-        }
+        DEBUGMSG(1, "  remove content chosen by replacement policy...\n");
+        struct ccnl_content_s *victim = ccnl_cache_victim(ccnl);
 
-        if (oldest) {
-            DEBUGMSG(1, "   replaced: '%s'\n",ccnl_prefix_to_path(oldest->name));
-            ccnl_content_remove(ccnl, oldest);
+        if (victim) {
+            DEBUGMSG(1, "   replaced: '%s'\n",ccnl_prefix_to_path(victim->name));
+            ccnl_content_remove(ccnl, victim);
         } else {
             DEBUGMSG(1, "   no dynamic content to remove...\n");
             break;
@@ -943,32 +1333,42 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     }
 
     DEBUGMSG(1, "  add new content to store: '%s'\n", ccnl_prefix_to_path(c->name));
+
+    if (ccnl_content_index(ccnl, c) < 0) {
+        DEBUGMSG(1, "  could not index content, not added to store\n");
+        return NULL;
+    }
+
     DBL_LINKED_LIST_ADD(ccnl->contents, c);
+    ccnl_cache_insert(ccnl, c);
+
+    if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+        ccnl_alist_append(&ccnl->content_ageing, &c->ageidx, c,
+                          c->last_used + CCNL_CONTENT_TIMEOUT);
+    }
+
     ccnl->contentcnt++;
     return c;
 }
 
-// deliver new content c to all clients with (loosely) matching interest,
-// but only one copy per face
-// returns: number of forwards
-int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
-                               struct ccnl_content_s *c)
+// deliver c, received on face from, to the pending interests whose full
+// name hashes to h, returns: number of forwards
+static int ccnl_content_serve_chain(struct ccnl_relay_s *ccnl,
+                                    struct ccnl_content_s *c,
+                                    struct ccnl_face_s *from, uint32_t h)
 {
+    struct ccnl_hlink_s *l, *next;
     struct ccnl_interest_s *i;
-    struct ccnl_face_s *f;
     int cnt = 0;
-    DEBUGMSG(99, "ccnl_content_serve_pending\n");
 
-    for (f = ccnl->faces; f; f = f->next) {
-        f->flags &= ~CCNL_FACE_FLAGS_SERVED;    // reply on a face only once
-    }
-
-    for (i = ccnl->pit; i;) {
+    for (l = ccnl_htab_lookup(&ccnl->pit_names, h); l; l = next) {
         struct ccnl_pendint_s *pi;
 
+        next = ccnl_htab_next(l);
+        i = (struct ccnl_interest_s *) l->obj;
+
         if (!ccnl_i_prefixof_c(i->prefix, i->ppkd, i->minsuffix, i->maxsuffix,
                                c)) {
-            i = i->next;
             continue;
         }
 
@@ -985,7 +1385,7 @@ int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
                 DEBUGMSG(6, "  forwarding content <%s>\n",
                          ccnl_prefix_to_path(c->name));
                 ccnl_print_stats(ccnl, STAT_SND_C); //log sent c
-                ccnl_face_enqueue(ccnl, pi->face, buf_dup(c->pkt));
+                ccnl_face_enqueue(ccnl, pi->face, ccnl_buf_ref(c->pkt));
             }
             else
                 // upcall to deliver content to local client
@@ -997,58 +1397,132 @@ int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
             cnt++;
         }
 
-        i = ccnl_interest_remove(ccnl, i);
+        ccnl_strategy_satisfied(ccnl, i, from);
+        ccnl_interest_remove(ccnl, i);
     }
 
     return cnt;
 }
 
+// deliver new content c, received on face from, to all clients with
+// (loosely) matching interest, but only one copy per face. Only the PIT
+// chains of the prefixes of c's name (plus its name extended by the
+// implicit digest) are visited.
+// returns: number of forwards
+int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl,
+                               struct ccnl_content_s *c,
+                               struct ccnl_face_s *from)
+{
+    struct ccnl_face_s *f;
+    unsigned char *md;
+    uint32_t h = CCNL_HASH_INIT;
+    int k, cnt = 0;
+    DEBUGMSG(99, "ccnl_content_serve_pending\n");
+
+    if (!ccnl->pit) {
+        return 0;
+    }
+
+    for (f = ccnl->faces; f; f = f->next) {
+        f->flags &= ~CCNL_FACE_FLAGS_SERVED;    // reply on a face only once
+    }
+
+    for (k = 0; ; k++) {
+        cnt += ccnl_content_serve_chain(ccnl, c, from, h);
+
+        if (k == c->name->compcnt) {
+            break;
+        }
+
+        h = ccnl_hash_component(h, c->name->comp[k], c->name->complen[k]);
+    }
+
+    // the digest is only worth its SHA256 if a pending interest may
+    // name it
+    md = ccnl->pit_digestcnt ? compute_ccnx_digest(c) : NULL;
+
+    if (md) {
+        h = ccnl_hash_component(h, md, SHA256_DIGEST_LENGTH);
+        cnt += ccnl_content_serve_chain(ccnl, c, from, h);
+    }
+
+    return cnt;
+}
+
+// retransmit the interests of the slot for second t which are due
+static void ccnl_do_retransmit(struct ccnl_relay_s *relay, int t)
+{
+    struct ccnl_alist_s *slot = relay->retransmit + t % CCNL_RETRANSMIT_SLOTS;
+    struct ccnl_alink_s *a = slot->tail, *prev;
+
+    // walk backwards: rescheduled interests are appended to another slot
+    for (; a; a = prev) {
+        struct ccnl_interest_s *i = (struct ccnl_interest_s *) a->obj;
+        prev = a->prev;
+
+        if (a->deadline > t) {
+            continue;
+        }
+
+        ccnl_alist_unlink(slot, a);
+        DEBUGMSG(7, " retransmit %d <%s>\n", i->retries,
+                 ccnl_prefix_to_path(i->prefix));
+        ccnl_strategy_timeout(relay, i);
+        i->retries++; // strategies treat retransmissions differently
+        ccnl_interest_propagate(relay, i);
+        ccnl_interest_schedule_retransmit(relay, i, t);
+    }
+}
+
+// ageing only visits entries which are due: expiry lists are sorted by
+// deadline and retransmissions are bucketed by second
 void ccnl_do_ageing(void *ptr, void *dummy)
 {
 
     (void) dummy; /* unused */
 
     struct ccnl_relay_s *relay = (struct ccnl_relay_s *) ptr;
-    struct ccnl_content_s *c = relay->contents;
-    struct ccnl_interest_s *i = relay->pit;
-    struct ccnl_face_s *f = relay->faces;
-    time_t t = CCNL_NOW();
-    DEBUGMSG(999, "ccnl_do_ageing %d\n", (int) t);
-
-    while (c) {
-        if ((c->last_used + CCNL_CONTENT_TIMEOUT) <= t
-            && !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-            c = ccnl_content_remove(relay, c);
-        }
-        else {
-            c = c->next;
+    struct ccnl_alink_s *a;
+    int t = CCNL_NOW(), s;
+    DEBUGMSG(999, "ccnl_do_ageing %d\n", t);
+
+    while ((a = relay->content_ageing.head) && a->deadline <= t) {
+        struct ccnl_content_s *c = (struct ccnl_content_s *) a->obj;
+
+        ccnl_alist_unlink(&relay->content_ageing, a);
+
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            ccnl_content_remove(relay, c);
         }
     }
 
-    while (i) { // CONFORM: "Entries in the PIT MUST timeout rather
-        // than being held indefinitely."
-        if ((i->last_used + CCNL_INTEREST_TIMEOUT) <= t ||
-            i->retries > CCNL_MAX_INTEREST_RETRANSMIT) {
-            i = ccnl_interest_remove(relay, i);
-        }
-        else {
-            // CONFORM: "A node MUST retransmit Interest Messages
-            // periodically for pending PIT entries."
-            DEBUGMSG(7, " retransmit %d <%s>\n", i->retries,
-                     ccnl_prefix_to_path(i->prefix));
-            ccnl_interest_propagate(relay, i);
-            i->retries++;
-            i = i->next;
-        }
+    // CONFORM: "Entries in the PIT MUST timeout rather than being held
+    // indefinitely."
+    while ((a = relay->pit_ageing.head) && a->deadline <= t) {
+        ccnl_strategy_timeout(relay, (struct ccnl_interest_s *) a->obj);
+        ccnl_interest_remove(relay, (struct ccnl_interest_s *) a->obj);
     }
 
-    while (f) {
-        if (!(f->flags & CCNL_FACE_FLAGS_STATIC)
-            && (f->last_used + CCNL_FACE_TIMEOUT) <= t) {
-            f = ccnl_face_remove(relay, f);
-        }
-        else {
-            f = f->next;
+    // catch up on the seconds since the last run, at most one full round
+    s = relay->retransmit_time + 1;
+
+    if (t - s >= CCNL_RETRANSMIT_SLOTS) {
+        s = t - CCNL_RETRANSMIT_SLOTS + 1;
+    }
+
+    for (; s <= t; s++) {
+        ccnl_do_retransmit(relay, s);
+    }
+
+    relay->retransmit_time = t;
+
+    while ((a = relay->face_ageing.head) && a->deadline <= t) {
+        struct ccnl_face_s *f = (struct ccnl_face_s *) a->obj;
+
+        ccnl_alist_unlink(&relay->face_ageing, a);
+
+        if (!(f->flags & CCNL_FACE_FLAGS_STATIC)) {
+            ccnl_face_remove(relay, f);
         }
     }
 }
@@ -1070,15 +1544,15 @@ void ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
         ccnl_content_remove(ccnl, ccnl->contents);
     }
 
-    while (ccnl->nonces) {
-        struct ccnl_buf_s *tmp = ccnl->nonces->next;
-        ccnl_free(ccnl->nonces);
-        ccnl->nonces = tmp;
-    }
-
     for (k = 0; k < ccnl->ifcount; k++) {
         ccnl_interface_cleanup(ccnl->ifs + k);
     }
+
+    ccnl_fib_cleanup(ccnl);
+    ccnl_cache_cleanup(ccnl);
+    ccnl_htab_free(&ccnl->pit_names);
+    ccnl_htab_free(&ccnl->cs_names);
+    ccnl_htab_free(&ccnl->cs_pkts);
 }
 
 // ----------------------------------------------------------------------
@@ -1126,9 +1600,15 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
         // CONFORM: Step 1:
         if (aok & 0x01) { // honor "answer-from-existing-content-store" flag
-            for (c = relay->contents; c; c = c->next) {
-                if (!ccnl_i_prefixof_c(p, ppkd, minsfx, maxsfx, c)) {
-                    continue;
+            c = ccnl_content_lookup(relay, p, ppkd, minsfx, maxsfx);
+
+            if (c) {
+                ccnl_cache_hit(relay, c);
+                c->last_used = CCNL_NOW();
+
+                if (c->ageidx.obj) {
+                    ccnl_alist_append(&relay->content_ageing, &c->ageidx, c,
+                                      c->last_used + CCNL_CONTENT_TIMEOUT);
                 }
 
                 // FIXME: should check stale bit in aok here
@@ -1137,7 +1617,7 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                 ccnl_print_stats(relay, STAT_SND_C); //log sent_c
 
                 if (from->ifndx >= 0) {
-                    ccnl_face_enqueue(relay, from, buf_dup(c->pkt));
+                    ccnl_face_enqueue(relay, from, ccnl_buf_ref(c->pkt));
                 }
                 else {
                     ccnl_app_RX(relay, c);
@@ -1145,16 +1625,12 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
                 goto Skip;
             }
+
+            relay->cache.stats.misses++;
         }
 
         // CONFORM: Step 2: check whether interest is already known
-        for (i = relay->pit; i; i = i->next) {
-            if (!ccnl_prefix_cmp(i->prefix, NULL, p, CMP_EXACT)
-                && i->minsuffix == minsfx && i->maxsuffix == maxsfx
-                && ((!ppkd && !i->ppkd) || buf_equal(ppkd, i->ppkd))) {
-                break;
-            }
-        }
+        i = ccnl_interest_find(relay, p, minsfx, maxsfx, ppkd);
 
         if (!i) { // this is a new/unknown I request: create and propagate
             i = ccnl_interest_new(relay, from, &buf, &p, minsfx, maxsfx, &ppkd);
@@ -1183,15 +1659,14 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         ccnl_print_stats(relay, STAT_RCV_C); //log count recv_content
 
         // CONFORM: Step 1:
-        for (c = relay->contents; c; c = c->next)
-            if (buf_equal(c->pkt, buf)) {
-                goto Skip;    // content is dup
-            }
+        if (ccnl_content_find_dup(relay, buf)) {
+            goto Skip;    // content is dup
+        }
 
         c = ccnl_content_new(relay, &buf, &p, &ppkd, content, contlen);
 
         if (c) { // CONFORM: Step 2 (and 3)
-            if (!ccnl_content_serve_pending(relay, c)) { // unsolicited content
+            if (!ccnl_content_serve_pending(relay, c, from)) { // unsolicited content
                 // CONFORM: "A node MUST NOT forward unsolicited data [...]"
                 DEBUGMSG(7, "  removed because no matching interest\n");
                 free_content(c);
@@ -1200,7 +1675,10 @@ int ccnl_core_RX_i_or_c(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
             if (relay->max_cache_entries != 0) { // it's set to -1 or a limit
                 DEBUGMSG(7, "  adding content to cache\n");
-                ccnl_content_add2cache(relay, c);
+
+                if (!ccnl_content_add2cache(relay, c)) {
+                    free_content(c);
+                }
             }
             else {
                 DEBUGMSG(7, "  content not added to cache\n");
@@ -1213,7 +1691,9 @@ Skip:
     rc = 0;
 Done:
     free_prefix(p);
-    free_3ptr_list(buf, nonce, ppkd);
+    ccnl_buf_free(buf);
+    ccnl_buf_free(nonce);
+    ccnl_buf_free(ppkd);
     DEBUGMSG(1, "leaving\n");
     return rc;
 }
@@ -1287,6 +1767,9 @@ compile_string(void)
 #ifdef USE_DEBUG_MALLOC
                             "USE_DEBUG_MALLOC "
 #endif
+#ifdef CCNL_HEAP_STATS
+                            "CCNL_HEAP_STATS "
+#endif
 #ifdef USE_FRAG
                             "USE_FRAG "
 #endif
@@ -44,13 +44,18 @@
 
 #define CCNL_CONTENT_FLAGS_STATIC  0x01
 #define CCNL_CONTENT_FLAGS_STALE   0x02
+#define CCNL_CONTENT_FLAGS_DIGEST  0x04 // digest[] is valid
 
 enum {STAT_RCV_I, STAT_RCV_C, STAT_SND_I, STAT_SND_C, STAT_QLEN, STAT_EOP1};
 
 #include <inttypes.h>
 #include <time.h>
 
+#include "bloom.h"
+#include "sha256.h"
+
 #include "ccnl.h"
+#include "ccnl-hash.h"
 
 // ----------------------------------------------------------------------
 
@@ -65,6 +70,12 @@ struct ccnl_txrequest_s {
     struct ccnl_face_s *txdone_face;
 };
 
+// queue statistics of a face or interface, both queues drop at the tail
+struct ccnl_qstats_s {
+    unsigned long enqueued, dropped;
+    unsigned long dups; // faces only: packet was already in the queue
+};
+
 struct ccnl_if_s { // interface for packet IO
     sockunion addr;
     int sock;
@@ -76,19 +87,108 @@ struct ccnl_if_s { // interface for packet IO
     int qlen;  // number of pending sends
     int qfront; // index of next packet to send
     struct ccnl_txrequest_s queue[CCNL_MAX_IF_QLEN];
+    struct ccnl_qstats_s qstats;
     struct ccnl_sched_s *sched;
 };
 
+struct ccnl_relay_s;
+struct ccnl_content_s;
+struct ccnl_interest_s;
+struct ccnl_fib_node_s;
+
+// content store replacement: the policy keeps the non-static content
+// objects in up to two queues (head = most recently used) and picks the
+// victim in O(1), see ccnl-ext-cache.c
+struct ccnl_cache_queue_s {
+    struct ccnl_content_s *head, *tail;
+    int cnt;
+};
+
+struct ccnl_cache_stats_s {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long insertions;
+    unsigned long evictions;
+};
+
+struct ccnl_cache_policy_s {
+    const char *name;
+    void (*insert)(struct ccnl_relay_s *, struct ccnl_content_s *);
+    void (*hit)(struct ccnl_relay_s *, struct ccnl_content_s *);
+    struct ccnl_content_s *(*victim)(struct ccnl_relay_s *);
+};
+
+// forwarding strategy (ccnl-ext-strategy.c)
+struct ccnl_strategy_s {
+    const char *name;
+    // sends i to some of n's next hops, returns how many
+    int (*forward)(struct ccnl_relay_s *, struct ccnl_interest_s *,
+                   struct ccnl_fib_node_s *);
+};
+
+struct ccnl_cache_s {
+    struct ccnl_cache_policy_s *policy;
+    struct ccnl_cache_queue_s q[2]; // LRU: q[0]; 2Q: q[0]=A1in, q[1]=Am
+    int qmax;                       // 2Q: target length of A1in
+    struct ccnl_htab_s ghost;       // 2Q: A1out, name hashes only
+    struct ccnl_hlink_s *ghostring;
+    int ghostsize, ghostpos;
+    struct ccnl_cache_stats_s stats;
+};
+
+// expiry ordered list for incremental ageing. All entries of a list have
+// the same lifetime, so appending an entry whenever it is refreshed keeps
+// the list sorted by deadline and ageing only looks at expired entries.
+struct ccnl_alink_s {
+    struct ccnl_alink_s *next, *prev;
+    int deadline;
+    void *obj; // NULL while not linked
+};
+
+struct ccnl_alist_s {
+    struct ccnl_alink_s *head, *tail;
+};
+
+struct ccnl_nonce_stats_s {
+    unsigned long checks;
+    unsigned long dups;      // dropped interests, includes false positives
+    unsigned long rotations;
+};
+
+// duplicate nonce suppression: two Bloom filter generations, new nonces go
+// into the current one, lookups check both. When the current generation is
+// full or older than CCNL_NONCE_TIMEOUT, the previous one is cleared and
+// becomes the current one, so a nonce is remembered for at least one
+// generation.
+struct ccnl_nonce_filter_s {
+    struct bloom_t gen[2];
+    uint8_t bits[2][CCNL_NONCE_BLOOM_BITS / 8];
+    int cur;     // index of the current generation
+    int cnt;     // nonces in the current generation
+    int started; // when the current generation was started
+    struct ccnl_nonce_stats_s stats;
+};
+
 struct ccnl_relay_s {
     time_t startup_time;
     int id;
     struct ccnl_face_s *faces;
-    struct ccnl_forward_s *fib;
+    struct ccnl_forward_s *fib;   // all FIB entries, see also fib_nodes
+    struct ccnl_htab_s fib_nodes; // FIB trie: prefix hash -> ccnl_fib_node_s
     struct ccnl_interest_s *pit;
+    struct ccnl_htab_s pit_names; // PIT index: interest name hash -> interest
+    int pit_digestcnt;  // PIT names which may end in an implicit digest
     struct ccnl_content_s *contents; //, *contentsend;
-    struct ccnl_buf_s *nonces;
+    struct ccnl_htab_s cs_names; // CS index: name prefix hash -> content
+    struct ccnl_htab_s cs_pkts;  // CS index: packet hash -> content
+    struct ccnl_nonce_filter_s nonces;
     int contentcnt;		// number of cached items
     int max_cache_entries;	// -1: unlimited
+    struct ccnl_cache_s cache;  // replacement policy state
+    struct ccnl_alist_s face_ageing, content_ageing, pit_ageing;
+    // interest retransmissions, one slot per second of their deadline:
+    struct ccnl_alist_s retransmit[CCNL_RETRANSMIT_SLOTS];
+    int retransmit_time; // last second whose slot has been processed
     struct ccnl_if_s ifs[CCNL_MAX_INTERFACES];
     int ifcount;		// number of active interfaces
     char halt_flag;
@@ -101,8 +201,13 @@ struct ccnl_relay_s {
     void *aux;
 };
 
+// packet buffers are reference counted: the PIT, the content store and
+// the face and interface queues share one copy of a packet, so the data
+// must not be modified once a buffer has been handed out
 struct ccnl_buf_s {
     struct ccnl_buf_s *next;
+    int refcnt;
+    int slab; // size class, see ccnl_buf_new(), -1: plain malloc
     unsigned int datalen;
     unsigned char data[1];
 };
@@ -112,6 +217,7 @@ struct ccnl_prefix_s {
     int *complen;
     int compcnt;
     unsigned char *path; // memory for name component copies
+    struct ccnl_buf_s *buf; // or the packet the components point into
 };
 
 struct ccnl_frag_s {
@@ -123,7 +229,27 @@ struct ccnl_frag_s {
     // transport state, if present:
     int ifndx;
 
+    // reassembly: fragments are appended at defraglen, defrag grows by
+    // doubling. Fragments which arrive ahead of recvseq wait in held[],
+    // until the gap is filled or gaptimer gives up on it.
     struct ccnl_buf_s *defrag;
+    unsigned int defraglen;
+    struct ccnl_frag_held_s {
+        struct ccnl_buf_s *buf; // NULL: slot is free
+        unsigned int seq;
+        unsigned int flags;
+    } held[CCNL_FRAG_REORDER_WINDOW];
+    int heldcnt;
+    void *gaptimer;
+    unsigned int recvmask; // sequence numbers wrap around at this mask
+    int (*rxcb)(struct ccnl_relay_s *, struct ccnl_face_s *,
+                unsigned char **, int *); // where held fragments go
+    struct ccnl_frag_stats_s {
+        unsigned long reassembled;
+        unsigned long reordered; // fragments held back and spliced in later
+        unsigned long dropped;   // duplicate, late or orphaned fragments
+        unsigned long aborted;   // partial packets given up
+    } stats;
 
     unsigned int sendseq;
     unsigned int losscount;
@@ -141,15 +267,44 @@ struct ccnl_face_s {
     sockunion peer;
     int flags;
     int last_used; // updated when we receive a packet
-    struct ccnl_buf_s *outq, *outqend; // queue of packets to send
+    struct ccnl_buf_s *outq[CCNL_MAX_FACE_QLEN]; // ring of packets to send
+    uint32_t outqhash[CCNL_MAX_FACE_QLEN]; // their hashes, for dup checks
+    int outqlen, outqfront;
+    struct ccnl_qstats_s qstats;
     struct ccnl_frag_s *frag;  // which special datagram armoring
     struct ccnl_sched_s *sched;
+    struct ccnl_alink_s ageidx;
+    struct ccnl_forward_s *fwd; // FIB entries with this face as next hop
 };
 
 struct ccnl_forward_s {
-    struct ccnl_forward_s *next;
+    struct ccnl_forward_s *next, *prev;
     struct ccnl_prefix_s *prefix;
     struct ccnl_face_s *face;
+    struct ccnl_forward_s *facenext, *faceprev; // face->fwd
+    int metric;                       // lower is better
+    struct ccnl_outrec_s *outrecs;    // PIT entries waiting for this hop
+    struct ccnl_fib_node_s *node;     // trie node of the prefix
+    struct ccnl_forward_s *nodenext;  // next hops of the same prefix
+    struct ccnl_fwd_stats_s {         // see ccnl-ext-strategy.c
+        int srtt, rttvar;             // usec
+        int sat;                      // satisfaction ratio, per mille
+        unsigned long sent, satisfied, missed;
+    } stats;
+};
+
+// FIB trie node, one per name component. The children of a node are not
+// stored in the node: they are found in relay->fib_nodes under the hash
+// of the prefix they represent (see ccnl-fib.c).
+struct ccnl_fib_node_s {
+    struct ccnl_fib_node_s *parent;   // NULL for the first component
+    struct ccnl_hlink_s link;
+    int childcnt;
+    struct ccnl_forward_s *fwd;       // next hops, sorted by metric
+    struct ccnl_strategy_s *strategy; // NULL: inherited from a parent
+    unsigned int probecnt;
+    int complen;
+    unsigned char comp[1];
 };
 
 struct ccnl_interest_s {
@@ -162,6 +317,15 @@ struct ccnl_interest_s {
     struct ccnl_buf_s *pkt;	   // full datagram
     int last_used;
     int retries;
+    struct ccnl_hlink_s pitidx; // PIT index link, hash of the full name
+    struct ccnl_alink_s ageidx; // expiry
+    struct ccnl_alink_s rtxidx; // next retransmission
+    struct ccnl_outrec_s {      // where the interest was sent to
+        struct ccnl_forward_s *fwd;
+        struct ccnl_outrec_s *next, *prev; // fwd->outrecs
+        double sent;
+        int retx;               // sent twice or overdue: no RTT sample
+    } out[CCNL_STRATEGY_MAX_OUT];
 };
 
 struct ccnl_pendint_s { // pending interest
@@ -182,6 +346,15 @@ struct ccnl_content_s {
     // >> CCNL: currently no stale bit, old content is fully removed <<
     int last_used;
     int served_cnt;
+    // CS index links, only valid while the content is in the cache:
+    struct ccnl_hlink_s *nameidx; // one per name component (prefix length)
+    struct ccnl_hlink_s pktidx;   // hash over the full datagram
+    // replacement policy queue, NULL for static content:
+    struct ccnl_cache_queue_s *queue;
+    struct ccnl_content_s *qnext, *qprev;
+    struct ccnl_alink_s ageidx; // expiry, only for non-static content
+    // implicit digest of pkt, computed on first use:
+    unsigned char digest[SHA256_DIGEST_LENGTH];
 };
 
 // ----------------------------------------------------------------------
@@ -215,6 +388,17 @@ void ccnl_core_cleanup(struct ccnl_relay_s *ccnl);
 struct ccnl_buf_s *
 ccnl_buf_new(void *data, int len);
 
+// takes another reference on b, NULL is passed through
+struct ccnl_buf_s *
+ccnl_buf_ref(struct ccnl_buf_s *b);
+
+// drops a reference, the last one frees the buffer
+void ccnl_buf_free(struct ccnl_buf_s *b);
+
+// frees the buffers kept for reuse, they are shared by all relay
+// instances, so only call this when none is left
+void ccnl_buf_slab_cleanup(void);
+
 struct ccnl_content_s *
 ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
                  struct ccnl_prefix_s **prefix, struct ccnl_buf_s **ppkd,
@@ -223,6 +407,13 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, struct ccnl_buf_s **pkt,
 struct ccnl_content_s *
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 
+struct ccnl_content_s *
+ccnl_content_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                    struct ccnl_buf_s *ppkd, int minsuffix, int maxsuffix);
+
+struct ccnl_content_s *
+ccnl_content_find_dup(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *pkt);
+
 struct ccnl_face_s *
 ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx, uint16_t sender_id);
 
@@ -232,6 +423,41 @@ int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
 struct ccnl_face_s *
 ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
 
+unsigned char *ccnl_content_digest(struct ccnl_content_s *c);
+
+int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
+                              struct ccnl_buf_s *nonce);
+
+void ccnl_nonce_print_stats(struct ccnl_relay_s *ccnl);
+
+#define CCNL_FIB_DEFAULT_METRIC 0
+
+struct ccnl_forward_s *
+ccnl_fib_add(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+             struct ccnl_face_s *f, int metric);
+
+int ccnl_fib_remove(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                    struct ccnl_face_s *f);
+
+void ccnl_fib_remove_entry(struct ccnl_relay_s *ccnl,
+                           struct ccnl_forward_s *fwd);
+
+void ccnl_fib_remove_face(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+
+struct ccnl_fib_node_s *
+ccnl_fib_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p);
+
+struct ccnl_fib_node_s *
+ccnl_fib_parent(struct ccnl_fib_node_s *n);
+
+int ccnl_fib_set_strategy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                          struct ccnl_strategy_s *s);
+
+struct ccnl_strategy_s *
+ccnl_fib_strategy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p);
+
+void ccnl_fib_cleanup(struct ccnl_relay_s *ccnl);
+
 struct ccnl_buf_s *
 ccnl_extract_prefix_nonce_ppkd(unsigned char **data, int *datalen, int *scope,
                                int *aok, int *min, int *max, struct ccnl_prefix_s **prefix,
@@ -245,10 +471,31 @@ void ccnl_interface_CTS(void *aux1, void *aux2);
 #define ccnl_app_RX(x,y)        do{}while(0)
 #define ccnl_print_stats(x,y)       do{}while(0)
 
+#ifdef CCNL_HEAP_STATS
+// heap accounting of the relay (ccnl-ext-debug.c), must be enabled for all
+// of ccn_lite at once, e.g. with CFLAGS += -DCCNL_HEAP_STATS
+struct ccnl_heap_stats_s {
+    unsigned long inuse, peak; // bytes
+    unsigned long allocs;
+};
+
+extern struct ccnl_heap_stats_s ccnl_heap_stats;
+
+void *ccnl_heap_malloc(size_t s);
+void *ccnl_heap_calloc(size_t n, size_t s);
+void *ccnl_heap_realloc(void *p, size_t s);
+void ccnl_heap_free(void *p);
+
+#define ccnl_malloc(s)  ccnl_heap_malloc(s)
+#define ccnl_calloc(n,s)    ccnl_heap_calloc(n,s)
+#define ccnl_realloc(p,s)   ccnl_heap_realloc(p,s)
+#define ccnl_free(p)        ccnl_heap_free(p)
+#else
 #define ccnl_malloc(s)  malloc(s)
 #define ccnl_calloc(n,s)    calloc(n,s)
 #define ccnl_realloc(p,s)   realloc(p,s)
 #define ccnl_free(p)        free(p)
+#endif
 
 void free_2ptr_list(void *a, void *b);
 void free_3ptr_list(void *a, void *b, void *c);
@@ -20,6 +20,8 @@
 
 #if RIOT_CCN_APPSERVER
 
+#include <ctype.h>
+
 #include "msg.h"
 #include "thread.h"
 #include "util/ccnl-riot-client.h"
@@ -36,41 +38,85 @@ static volatile int halt_flag;
 /** The size of the message queue between router daemon and transceiver AND clients */
 #define APPSERVER_MSG_BUFFER_SIZE (64)
 
+/** number of objects which can be published */
+#define APPSERVER_MAX_OBJECTS (4)
+
+/** max length of a published name, e.g. "/riot/appserver/test" */
+#define APPSERVER_NAME_LEN (64)
+
+/** upper bound of an encoded chunk: name, segment, tlv overhead, data */
+#define APPSERVER_PKT_SIZE (CCNL_RIOT_CHUNK_SIZE + APPSERVER_NAME_LEN + \
+                            6 * CCNL_MAX_NAME_COMP + 48)
+
+/** number of encoded chunks kept for reuse */
+#define APPSERVER_CACHE_SLOTS (8)
+
+/** size of the built-in test object */
+#define APPSERVER_TEST_SIZE (1000)
+
 /** message buffer */
 msg_t msg_buffer_appserver[APPSERVER_MSG_BUFFER_SIZE];
 
+/** buffer for the control requests and replies exchanged with the relay */
 unsigned char big_buf[2 * 1024];
 
 int relay_pid;
-char prefix[] = "/riot/appserver/";
 
+struct appserver_object_s {
+    char name[APPSERVER_NAME_LEN];      // as published
+    char comps[APPSERVER_NAME_LEN];     // the name split into components
+    char *comp[CCNL_MAX_NAME_COMP + 1]; // components, segment, NULL
+    int compcnt;
+    unsigned int len;
+    const unsigned char *data;          // memory backed object, or
+    ccnl_riot_appserver_read_t read;    // callback backed object
+    void *arg;
+};
+
+static struct appserver_object_s objects[APPSERVER_MAX_OBJECTS];
+static int objectcnt;
+
+// encoded chunks of the most requested segments, least hit is replaced
+struct appserver_chunk_s {
+    struct appserver_object_s *obj; // NULL: unused slot
+    int seg;
+    unsigned int hits;
+    int len;
+    unsigned char pkt[APPSERVER_PKT_SIZE];
+};
+
+static struct appserver_chunk_s chunkcache[APPSERVER_CACHE_SLOTS];
+static unsigned int chunklookups;
+
+// replies wait in the relay's message queue until it gets to them, so
+// every reply gets its own buffer, which the relay frees
 static int appserver_sent_content(uint8_t *buf, int len, uint16_t from)
 {
-    static riot_ccnl_msg_t rmsg;
-    rmsg.payload = buf;
-    rmsg.size = len;
-    DEBUGMSG(1, "datalen=%d\n", rmsg.size);
+    riot_ccnl_msg_t *rmsg = ccnl_malloc(sizeof(riot_ccnl_msg_t) + len);
+
+    if (!rmsg) {
+        DEBUGMSG(1, "  malloc failed...dropping reply!\n");
+        return 0;
+    }
+
+    rmsg->payload = (uint8_t *) rmsg + sizeof(riot_ccnl_msg_t);
+    rmsg->size = len;
+    memcpy(rmsg->payload, buf, len);
+    DEBUGMSG(1, "datalen=%d\n", rmsg->size);
 
     msg_t m;
-    m.type = CCNL_RIOT_MSG;
-    m.content.ptr = (char *) &rmsg;
+    m.type = CCNL_RIOT_MSG_OWNED;
+    m.content.ptr = (char *) rmsg;
     uint16_t dest_pid = from;
     DEBUGMSG(1, "sending msg to pid=%u\n", dest_pid);
     int ret = msg_send(&m, dest_pid, 1);
     DEBUGMSG(1, "msg_reply returned: %d\n", ret);
-    return ret;
-}
 
-static int appserver_create_content(char **prefix, uint8_t *out)
-{
-    char buf[CCNL_RIOT_CHUNK_SIZE - 1];
-
-    for (int i = 0; i < CCNL_RIOT_CHUNK_SIZE - 1; i++) {
-        buf[i] = 'a' + i%26;
+    if (ret != 1) {
+        ccnl_free(rmsg);
     }
 
-    int len = mkContent(prefix, buf, CCNL_RIOT_CHUNK_SIZE - 1, out);
-    return len;
+    return ret;
 }
 
 static int appserver_create_prefix(char *name, char **prefix)
@@ -78,6 +124,7 @@ static int appserver_create_prefix(char *name, char **prefix)
     int i = 0;
     char *cp = strtok(name, "/");
 
+    // leave room for the segment component
     while (i < (CCNL_MAX_NAME_COMP - 1) && cp) {
         prefix[i++] = cp;
         cp = strtok(NULL, "/");
@@ -88,27 +135,235 @@ static int appserver_create_prefix(char *name, char **prefix)
     return i;
 }
 
+static int appserver_publish(char *name, unsigned int len,
+                             const unsigned char *data,
+                             ccnl_riot_appserver_read_t read, void *arg)
+{
+    struct appserver_object_s *o;
+
+    if (objectcnt >= APPSERVER_MAX_OBJECTS || strlen(name) >= APPSERVER_NAME_LEN) {
+        return -1;
+    }
+
+    o = objects + objectcnt;
+    memset(o, 0, sizeof(*o));
+    strcpy(o->name, name);
+    strcpy(o->comps, name);
+    o->compcnt = appserver_create_prefix(o->comps, o->comp);
+
+    if (!o->compcnt) {
+        return -1;
+    }
+
+    o->len = len;
+    o->data = data;
+    o->read = read;
+    o->arg = arg;
+    objectcnt++;
+    return 0;
+}
+
+int ccnl_riot_appserver_publish(char *name, const unsigned char *data,
+                                unsigned int len)
+{
+    return appserver_publish(name, len, data, NULL, NULL);
+}
+
+int ccnl_riot_appserver_publish_cb(char *name, unsigned int len,
+                                   ccnl_riot_appserver_read_t read, void *arg)
+{
+    return appserver_publish(name, len, NULL, read, arg);
+}
+
+/*
+ * Segment n holds the bytes [n * CCNL_RIOT_CHUNK_SIZE, (n + 1) *
+ * CCNL_RIOT_CHUNK_SIZE) of the object. The last segment is always shorter
+ * than a chunk, possibly empty, so that clients which only look at the
+ * chunk size also find the end.
+ */
+static int appserver_create_content(struct appserver_object_s *o, int seg,
+                                    uint8_t *out)
+{
+    unsigned char buf[CCNL_RIOT_CHUNK_SIZE];
+    const unsigned char *data;
+    char segment_string[16];
+    int last = o->len / CCNL_RIOT_CHUNK_SIZE;
+    unsigned int offs;
+    int len;
+
+    if (seg < 0 || seg > last) {
+        return -1;
+    }
+
+    offs = (unsigned int) seg * CCNL_RIOT_CHUNK_SIZE;
+
+    len = seg < last ? CCNL_RIOT_CHUNK_SIZE : (int)(o->len - offs);
+
+    if (o->data) {
+        data = o->data + offs;
+    }
+    else {
+        if (len > 0 && o->read(o->arg, offs, buf, len) != len) {
+            return -1;
+        }
+
+        data = buf;
+    }
+
+    snprintf(segment_string, sizeof(segment_string), "%d", seg);
+    o->comp[o->compcnt] = segment_string;
+    o->comp[o->compcnt + 1] = NULL;
+
+    if (seg < last) {
+        len = mkContent(o->comp, (char *) data, len, out);
+    }
+    else {
+        len = mkFinalContent(o->comp, (char *) data, len, out);
+    }
+
+    o->comp[o->compcnt] = NULL;
+    return len;
+}
+
+static struct appserver_chunk_s *
+appserver_get_chunk(struct appserver_object_s *o, int seg)
+{
+    struct appserver_chunk_s *c, *victim = chunkcache;
+    int i;
+
+    // age the hit counts so that formerly popular chunks can be replaced
+    if (++chunklookups % (16 * APPSERVER_CACHE_SLOTS) == 0) {
+        for (i = 0; i < APPSERVER_CACHE_SLOTS; i++) {
+            chunkcache[i].hits /= 2;
+        }
+    }
+
+    for (i = 0; i < APPSERVER_CACHE_SLOTS; i++) {
+        c = chunkcache + i;
+
+        if (c->obj == o && c->seg == seg) {
+            c->hits++;
+            return c;
+        }
+
+        if (!c->obj || (victim->obj && c->hits < victim->hits)) {
+            victim = c;
+        }
+    }
+
+    victim->obj = NULL;
+    victim->len = appserver_create_content(o, seg, victim->pkt);
+
+    if (victim->len < 0) {
+        return NULL;
+    }
+
+    victim->obj = o;
+    victim->seg = seg;
+    victim->hits = 1;
+    return victim;
+}
+
+// the published object p is a segment (or the plain name) of, and the segment
+static struct appserver_object_s *
+appserver_find_object(struct ccnl_prefix_s *p, int *seg)
+{
+    char segment_string[16];
+    unsigned long n;
+    int i, k, len;
+
+    for (i = 0; i < objectcnt; i++) {
+        struct appserver_object_s *o = objects + i;
+
+        if (p->compcnt != o->compcnt && p->compcnt != o->compcnt + 1) {
+            continue;
+        }
+
+        for (k = 0; k < o->compcnt; k++) {
+            if (p->complen[k] != (int) strlen(o->comp[k])
+                || memcmp(p->comp[k], o->comp[k], p->complen[k])) {
+                break;
+            }
+        }
+
+        if (k < o->compcnt) {
+            continue;
+        }
+
+        if (p->compcnt == o->compcnt) {
+            *seg = 0;
+            return o;
+        }
+
+        len = p->complen[k];
+
+        if (len <= 0 || len >= (int) sizeof(segment_string)) {
+            return NULL;
+        }
+
+        memcpy(segment_string, p->comp[k], len);
+        segment_string[len] = '\0';
+
+        for (k = 0; k < len; k++) {
+            if (!isdigit((unsigned char) segment_string[k])) {
+                return NULL;
+            }
+        }
+
+        // digits only, strtoul() saturates instead of overflowing
+        n = strtoul(segment_string, NULL, 10);
+
+        if (n > o->len / CCNL_RIOT_CHUNK_SIZE) {
+            return NULL;
+        }
+
+        *seg = (int) n;
+        return o;
+    }
+
+    return NULL;
+}
+
 static int appserver_handle_interest(char *data, uint16_t datalen, uint16_t from)
 {
-    (void) data;
-    (void) datalen;
+    unsigned char *cp = (unsigned char *) data;
+    int len = datalen, num, typ, seg, ret = -1;
+    int scope = 3, aok = 3, minsfx = 0, maxsfx = CCNL_MAX_NAME_COMP, contlen;
+    struct ccnl_buf_s *buf, *nonce = 0, *ppkd = 0;
+    struct ccnl_prefix_s *p = 0;
+    struct appserver_object_s *o;
+    struct appserver_chunk_s *c;
+    unsigned char *content = 0;
+
+    if (dehead(&cp, &len, &num, &typ) != 0 || typ != CCN_TT_DTAG
+        || num != CCN_DTAG_INTEREST) {
+        DEBUGMSG(1, "APPSERVER: not an interest\n");
+        return -1;
+    }
 
-    char *prefix[CCNL_MAX_NAME_COMP];
-    //struct ccnl_interest_s *i = appserver_parse_interest(data, datalen);
+    buf = ccnl_extract_prefix_nonce_ppkd(&cp, &len, &scope, &aok, &minsfx,
+                                         &maxsfx, &p, &nonce, &ppkd, &content,
+                                         &contlen);
 
-    char name[] = "/riot/appserver/test/0";
-    appserver_create_prefix(name, prefix);
+    if (!buf) {
+        DEBUGMSG(1, "APPSERVER: parsing error\n");
+        return -1;
+    }
 
-    int len = appserver_create_content(prefix, big_buf);
-    /*
-     struct ccnl_prefix *myprefix = ccnl_path_to_prefix(name);
+    o = appserver_find_object(p, &seg);
+    c = o ? appserver_get_chunk(o, seg) : NULL;
 
-     if (ccnl_prefix_cmp(myprefix, 0, i->prefix, CMP_EXACT) != CMP_EXACT) {
-     DEBUGMSG(1, "APPSERVER: it's a match");
-     }
-     */
-    int ret = appserver_sent_content(big_buf, len, from);
+    if (c) {
+        ret = appserver_sent_content(c->pkt, c->len, from);
+    }
+    else {
+        DEBUGMSG(1, "APPSERVER: no such object or segment\n");
+    }
 
+    free_prefix(p);
+    ccnl_buf_free(buf);
+    ccnl_buf_free(nonce);
+    ccnl_buf_free(ppkd);
     return ret;
 }
 
@@ -133,6 +388,7 @@ static void riot_ccnl_appserver_ioloop(void)
                 DEBUGMSG(1, "new msg: size=%" PRIu16 " sender_pid=%" PRIu16 "\n",
                          m->size, in.sender_pid);
                 appserver_handle_interest(m->payload, m->size, in.sender_pid);
+                ccnl_free(m); // allocated by riot_send_msg()
                 break;
 
             default:
@@ -144,20 +400,46 @@ static void riot_ccnl_appserver_ioloop(void)
     }
 }
 
+static int appserver_test_read(void *arg, unsigned int offs,
+                               unsigned char *buf, int len)
+{
+    (void) arg; /* unused */
+
+    for (int i = 0; i < len; i++) {
+        buf[i] = 'a' + (offs + i) % 26;
+    }
+
+    return len;
+}
+
 static void riot_ccnl_appserver_register(void)
 {
     char faceid[10];
+    char name[APPSERVER_NAME_LEN];
     snprintf(faceid, sizeof(faceid), "%d", thread_getpid());
     char *type = "newMSGface";
 
-    int content_len = ccnl_riot_client_publish(relay_pid, prefix, faceid, type, big_buf);
-    DEBUG("received %d bytes.\n", content_len);
-    DEBUG("appserver received: '%s'\n", big_buf);
+    ccnl_riot_client_new_face(relay_pid, type, faceid, big_buf);
+
+    for (int i = 0; i < objectcnt; i++) {
+        strcpy(name, objects[i].name); // the request builder tokenizes it
+        int content_len = ccnl_riot_client_register_prefix(relay_pid, name,
+                          faceid, big_buf);
+        DEBUG("received %d bytes.\n", content_len);
+        DEBUG("appserver received: '%s'\n", big_buf);
+    }
 }
 
 void ccnl_riot_appserver_start(int _relay_pid)
 {
     relay_pid = _relay_pid;
+
+    if (!objectcnt) {
+        ccnl_riot_appserver_publish_cb("/riot/appserver/test",
+                                       APPSERVER_TEST_SIZE,
+                                       appserver_test_read, NULL);
+    }
+
     riot_ccnl_appserver_register();
     riot_ccnl_appserver_ioloop();
     DEBUGMSG(1, "appserver terminated\n");
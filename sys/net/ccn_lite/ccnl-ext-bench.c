@@ -0,0 +1,355 @@
+/*
+ * @f ccnl-ext-bench.c
+ * @b CCN lite extension, synthetic workload generator for the relay
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * The benchmark runs a private relay with two loopback interfaces: the
+ * consumer (ifs[0]) injects interests straight into ccnl_core_RX(), the
+ * producer (ifs[1]) is the only next hop of /bench and answers every
+ * interest it sees right away. Names are drawn from a Zipf distribution
+ * by a seeded PRNG and nothing depends on timers, so two runs with the
+ * same parameters do the same work; only the measured times differ.
+ *
+ * Only built with CFLAGS += -DCCNL_BENCH, never together with a relay
+ * that is supposed to run in production.
+ */
+
+#ifdef CCNL_BENCH
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-pdu.h"
+#include "ccnl-riot.h"
+
+#include "vtimer.h"
+
+#define BENCH_CONSUMER_IDX  0
+#define BENCH_PRODUCER_IDX  1
+#define BENCH_CONSUMER_ID   1
+#define BENCH_PRODUCER_ID   2
+
+// state shared with the loopback send functions, one run at a time
+static struct {
+    unsigned int producer_asked;   // interests which reached the producer
+    unsigned int delivered;        // content packets the consumer got
+    int answered;                  // current interest has been answered
+    timex_t sent;                  // when the current interest was injected
+    uint32_t latency;              // usec, of the current interest
+} bench;
+
+static uint32_t bench_rand_state;
+
+// xorshift32, deterministic for a given seed
+static uint32_t bench_rand(void)
+{
+    uint32_t x = bench_rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return bench_rand_state = x;
+}
+
+static uint32_t bench_usec_since(timex_t t)
+{
+    timex_t now;
+
+    vtimer_now(&now);
+    now = timex_sub(now, t);
+    return now.seconds * 1000000 + now.microseconds;
+}
+
+static int bench_consumer_TX(uint8_t *buf, uint16_t size, uint16_t to)
+{
+    (void) buf; /* unused */
+    (void) to; /* unused */
+
+    bench.delivered++;
+
+    if (!bench.answered) {
+        bench.latency = bench_usec_since(bench.sent);
+        bench.answered = 1;
+    }
+
+    return size;
+}
+
+static int bench_producer_TX(uint8_t *buf, uint16_t size, uint16_t to)
+{
+    (void) buf; /* unused */
+    (void) to; /* unused */
+
+    // only the interest just injected can be pending, see ccnl_riot_bench()
+    bench.producer_asked++;
+    return size;
+}
+
+// cumulative Zipf distribution over 1..n: cdf[k-1] = P(X <= k)
+static double *bench_zipf_cdf(unsigned int n, unsigned int alpha)
+{
+    double *cdf = malloc(n * sizeof(double));
+    double sum = 0;
+    unsigned int k;
+
+    if (!cdf) {
+        return NULL;
+    }
+
+    for (k = 0; k < n; k++) {
+        sum += 1.0 / pow(k + 1, alpha / 100.0);
+        cdf[k] = sum;
+    }
+
+    for (k = 0; k < n; k++) {
+        cdf[k] /= sum;
+    }
+
+    return cdf;
+}
+
+static unsigned int bench_zipf_draw(double *cdf, unsigned int n)
+{
+    double u = bench_rand() / 4294967296.0;
+    unsigned int lo = 0, hi = n - 1;
+
+    while (lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+
+        if (cdf[mid] < u) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static int bench_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+// /bench/c1/../c<namelen-2>/<item>, namecomp must hold namelen+1 entries,
+// namelen <= CCNL_MAX_NAME_COMP
+static void bench_name(char **namecomp, char *itembuf, unsigned int namelen,
+                       unsigned int item)
+{
+    static char *pad[] = {"c1", "c2", "c3", "c4", "c5", "c6", "c7", "c8",
+                          "c9", "c10", "c11", "c12", "c13", "c14"
+                         };
+    unsigned int i;
+
+    namecomp[0] = "bench";
+
+    for (i = 1; i < namelen - 1; i++) {
+        namecomp[i] = pad[i - 1];
+    }
+
+    sprintf(itembuf, "%u", item);
+    namecomp[namelen - 1] = itembuf;
+    namecomp[namelen] = 0;
+}
+
+static void bench_relay_init(struct ccnl_relay_s *relay,
+                             const ccnl_riot_bench_cfg_t *cfg)
+{
+    unsigned char *comp[1] = {(unsigned char *) "bench"};
+    int complen[1] = {5};
+    struct ccnl_prefix_s p;
+    struct ccnl_face_s *f;
+    struct ccnl_if_s *i;
+
+    memset(relay, 0, sizeof(*relay));
+    relay->max_cache_entries = cfg->cache_entries;
+    ccnl_cache_init(relay, NULL);
+
+    i = relay->ifs + BENCH_CONSUMER_IDX;
+    i->sendfunc = bench_consumer_TX;
+    i->mtu = CCNL_MAX_PACKET_SIZE;
+    i = relay->ifs + BENCH_PRODUCER_IDX;
+    i->sendfunc = bench_producer_TX;
+    i->mtu = CCNL_MAX_PACKET_SIZE;
+    relay->ifcount = 2;
+
+    f = ccnl_get_face_or_create(relay, BENCH_CONSUMER_IDX, BENCH_CONSUMER_ID);
+
+    if (f) {
+        f->flags |= CCNL_FACE_FLAGS_STATIC;
+    }
+
+    f = ccnl_get_face_or_create(relay, BENCH_PRODUCER_IDX, BENCH_PRODUCER_ID);
+
+    if (f) {
+        memset(&p, 0, sizeof(p));
+        p.comp = comp;
+        p.complen = complen;
+        p.compcnt = 1;
+        f->flags |= CCNL_FACE_FLAGS_STATIC;
+        ccnl_fib_add(relay, &p, f, CCNL_FIB_DEFAULT_METRIC);
+    }
+}
+
+int ccnl_riot_bench(const ccnl_riot_bench_cfg_t *cfg,
+                    ccnl_riot_bench_result_t *res)
+{
+    struct ccnl_relay_s *relay = NULL;
+    char *namecomp[CCNL_MAX_NAME_COMP + 1], item[12];
+    unsigned char *pkt = NULL;
+    char *payload = NULL;
+    double *cdf = NULL;
+    uint32_t *lat = NULL;
+    unsigned int n, answered = 0, pitmax = 0;
+    unsigned long hits, lookups;
+    timex_t start;
+    int len, rc = -1;
+#ifdef CCNL_HEAP_STATS
+    unsigned long heapbase;
+#endif
+
+    if (!cfg->catalogue || !cfg->interests || cfg->namelen < 2
+        || cfg->namelen > CCNL_MAX_NAME_COMP) {
+        puts("bench: invalid parameters");
+        return -1;
+    }
+
+    // the slab, the timer pool and ccnl_heap_stats are global and the
+    // relay code takes no locks, see ccnl_riot_bench() in ccnl-riot.h
+    if (ccnl_riot_relay_running()) {
+        puts("bench: stop the relay first");
+        return -1;
+    }
+
+    // bookkeeping of the benchmark itself is not taken from the relay's heap
+    relay = malloc(sizeof(*relay));
+    pkt = malloc(cfg->contentlen + 64 * (cfg->namelen + 2));
+    payload = malloc(cfg->contentlen + 1);
+    lat = malloc(cfg->interests * sizeof(uint32_t));
+    cdf = bench_zipf_cdf(cfg->catalogue, cfg->zipf);
+
+    if (!relay || !pkt || !payload || !lat || !cdf) {
+        puts("bench: out of memory");
+        goto Done;
+    }
+
+    memset(&bench, 0, sizeof(bench));
+    bench_rand_state = cfg->seed ? cfg->seed : 1;
+    memset(payload, 'x', cfg->contentlen);
+#ifdef CCNL_HEAP_STATS
+    heapbase = ccnl_heap_stats.inuse;
+    ccnl_heap_stats.peak = heapbase;
+#endif
+    bench_relay_init(relay, cfg);
+
+    vtimer_now(&start);
+
+    for (n = 0; n < cfg->interests; n++) {
+        unsigned int k = bench_zipf_draw(cdf, cfg->catalogue);
+        unsigned int nonce = bench_rand(), asked = bench.producer_asked;
+
+        bench_name(namecomp, item, cfg->namelen, k);
+        len = mkInterest(namecomp, &nonce, pkt);
+
+        bench.answered = 0;
+        vtimer_now(&bench.sent);
+        ccnl_core_RX(relay, BENCH_CONSUMER_IDX, pkt, len, BENCH_CONSUMER_ID);
+
+        if (relay->pit_names.cnt > pitmax) {
+            pitmax = relay->pit_names.cnt;
+        }
+
+        if (bench.producer_asked != asked) { // a miss: the producer answers
+            len = mkContent(namecomp, payload, cfg->contentlen, pkt);
+            ccnl_core_RX(relay, BENCH_PRODUCER_IDX, pkt, len,
+                         BENCH_PRODUCER_ID);
+        }
+
+        if (bench.answered) {
+            lat[answered++] = bench.latency;
+        }
+    }
+
+    res->usec = bench_usec_since(start);
+    res->interests = cfg->interests;
+    res->answered = answered;
+    res->upstream = bench.producer_asked;
+    res->pit_max = pitmax;
+    hits = relay->cache.stats.hits;
+    lookups = hits + relay->cache.stats.misses;
+    res->hit_permille = lookups ? (1000 * hits) / lookups : 0;
+    memset(res->lat_usec, 0, sizeof(res->lat_usec));
+
+    if (answered) {
+        qsort(lat, answered, sizeof(uint32_t), bench_cmp_u32);
+        res->lat_usec[0] = lat[answered / 2];
+        res->lat_usec[1] = lat[(answered * 9) / 10];
+        res->lat_usec[2] = lat[(answered * 99) / 100];
+        res->lat_usec[3] = lat[answered - 1];
+    }
+
+#ifdef CCNL_HEAP_STATS
+    res->heap_peak = ccnl_heap_stats.peak - heapbase;
+#else
+    res->heap_peak = 0;
+#endif
+
+    ccnl_core_cleanup(relay);
+    rc = 0;
+
+Done:
+    free(cdf);
+    free(lat);
+    free(payload);
+    free(pkt);
+    free(relay);
+    return rc;
+}
+
+void ccnl_riot_bench_print(const ccnl_riot_bench_cfg_t *cfg,
+                           const ccnl_riot_bench_result_t *res)
+{
+    printf("bench: catalogue=%u namelen=%u zipf=%u.%02u cache=%d"
+           " interests=%u contentlen=%u seed=%u\n", cfg->catalogue,
+           cfg->namelen, cfg->zipf / 100, cfg->zipf % 100, cfg->cache_entries,
+           cfg->interests, cfg->contentlen, cfg->seed);
+    printf("  time=%luus rate=%lu/s answered=%u upstream=%u\n",
+           (unsigned long) res->usec,
+           res->usec ? (unsigned long)((uint64_t) res->interests * 1000000
+                                       / res->usec) : 0,
+           res->answered, res->upstream);
+    printf("  hitratio=%u.%u%% pitmax=%u\n", res->hit_permille / 10,
+           res->hit_permille % 10, res->pit_max);
+    printf("  latency p50=%luus p90=%luus p99=%luus max=%luus\n",
+           (unsigned long) res->lat_usec[0], (unsigned long) res->lat_usec[1],
+           (unsigned long) res->lat_usec[2], (unsigned long) res->lat_usec[3]);
+#ifdef CCNL_HEAP_STATS
+    printf("  heap peak=%lu bytes\n", res->heap_peak);
+#else
+    printf("  heap peak=n/a (build with -DCCNL_HEAP_STATS)\n");
+#endif
+}
+
+#endif // CCNL_BENCH
+// eof
@@ -0,0 +1,331 @@
+/*
+ * @f ccnl-ext-cache.c
+ * @b CCN lite extension, content store replacement policies
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * All policies work on the queues in struct ccnl_cache_s, every operation
+ * is O(1). Static content (CCNL_CONTENT_FLAGS_STATIC) is never queued and
+ * thus never evicted. The relay starts with CCNL_DEFAULT_CACHE_POLICY, a
+ * CCNL_RIOT_CACHE_POLICY message switches it by name at run time and
+ * CCNL_RIOT_PRINT_STAT prints the counters.
+ *
+ * lru: one queue, a hit moves the content to the head, the tail is evicted
+ *
+ * 2q:  scan resistant "simplified 2Q" (Johnson/Shasha, VLDB'94). New
+ *      content enters the FIFO A1in, content which is requested again
+ *      after having been evicted from A1in (its name is still in the
+ *      ghost list A1out) enters the LRU queue Am. A one-time scan over
+ *      many names therefore only flushes A1in, not the popular content.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+
+#define A1IN    0
+#define AM      1
+
+// ----------------------------------------------------------------------
+// queue primitives
+
+static void cache_q_push(struct ccnl_cache_queue_s *q, struct ccnl_content_s *c)
+{
+    c->queue = q;
+    c->qprev = NULL;
+    c->qnext = q->head;
+
+    if (q->head) {
+        q->head->qprev = c;
+    }
+    else {
+        q->tail = c;
+    }
+
+    q->head = c;
+    q->cnt++;
+}
+
+static void cache_q_unlink(struct ccnl_content_s *c)
+{
+    struct ccnl_cache_queue_s *q = c->queue;
+
+    if (c->qprev) {
+        c->qprev->qnext = c->qnext;
+    }
+    else {
+        q->head = c->qnext;
+    }
+
+    if (c->qnext) {
+        c->qnext->qprev = c->qprev;
+    }
+    else {
+        q->tail = c->qprev;
+    }
+
+    c->queue = NULL;
+    c->qnext = c->qprev = NULL;
+    q->cnt--;
+}
+
+// tail of the queue, dropping content which became static meanwhile
+static struct ccnl_content_s *cache_q_tail(struct ccnl_cache_queue_s *q)
+{
+    while (q->tail && (q->tail->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+        cache_q_unlink(q->tail);
+    }
+
+    return q->tail;
+}
+
+static uint32_t cache_name_hash(struct ccnl_content_s *c)
+{
+    if (c->nameidx) {
+        return c->nameidx[c->name->compcnt - 1].hash;
+    }
+
+    return ccnl_prefix_hash(c->name, c->name->compcnt);
+}
+
+// ----------------------------------------------------------------------
+// LRU
+
+static void lru_insert(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    cache_q_push(ccnl->cache.q, c);
+}
+
+static void lru_hit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    (void) ccnl; /* unused */
+
+    struct ccnl_cache_queue_s *q = c->queue;
+
+    cache_q_unlink(c);
+    cache_q_push(q, c);
+}
+
+static struct ccnl_content_s *lru_victim(struct ccnl_relay_s *ccnl)
+{
+    return cache_q_tail(ccnl->cache.q);
+}
+
+struct ccnl_cache_policy_s ccnl_cache_lru = {
+    "lru", lru_insert, lru_hit, lru_victim
+};
+
+// ----------------------------------------------------------------------
+// 2Q
+
+static void twoq_insert(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_cache_s *cache = &ccnl->cache;
+
+    if (ccnl_htab_lookup(&cache->ghost, cache_name_hash(c))) {
+        cache_q_push(cache->q + AM, c); // seen before: it is popular
+    }
+    else {
+        cache_q_push(cache->q + A1IN, c);
+    }
+}
+
+static void twoq_hit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    // correlated references in A1in do not promote the content
+    if (c->queue == ccnl->cache.q + AM) {
+        cache_q_unlink(c);
+        cache_q_push(ccnl->cache.q + AM, c);
+    }
+}
+
+static void twoq_remember(struct ccnl_cache_s *cache, struct ccnl_content_s *c)
+{
+    struct ccnl_hlink_s *l;
+
+    if (!cache->ghostsize) {
+        return;
+    }
+
+    l = cache->ghostring + cache->ghostpos;
+    cache->ghostpos = (cache->ghostpos + 1) % cache->ghostsize;
+
+    if (l->obj) { // ring is full: forget the oldest name
+        ccnl_htab_remove(&cache->ghost, l);
+    }
+
+    l->hash = cache_name_hash(c);
+    l->obj = l;
+    ccnl_htab_add(&cache->ghost, l);
+}
+
+static struct ccnl_content_s *twoq_victim(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_cache_s *cache = &ccnl->cache;
+    struct ccnl_content_s *c = cache_q_tail(cache->q + A1IN);
+
+    if (c && (cache->q[A1IN].cnt > cache->qmax || !cache_q_tail(cache->q + AM))) {
+        twoq_remember(cache, c);
+        return c;
+    }
+
+    c = cache_q_tail(cache->q + AM);
+    return c ? c : cache_q_tail(cache->q + A1IN);
+}
+
+struct ccnl_cache_policy_s ccnl_cache_2q = {
+    "2q", twoq_insert, twoq_hit, twoq_victim
+};
+
+// ----------------------------------------------------------------------
+
+struct ccnl_cache_policy_s *
+ccnl_cache_policy_by_name(const char *name)
+{
+    static struct ccnl_cache_policy_s *policies[] = {
+        &ccnl_cache_lru, &ccnl_cache_2q, NULL
+    };
+    int i;
+
+    for (i = 0; policies[i]; i++) {
+        if (!strcmp(policies[i]->name, name)) {
+            return policies[i];
+        }
+    }
+
+    return NULL;
+}
+
+int ccnl_cache_init(struct ccnl_relay_s *ccnl,
+                    struct ccnl_cache_policy_s *policy)
+{
+    struct ccnl_cache_s *cache = &ccnl->cache;
+    struct ccnl_content_s *c;
+
+    ccnl_cache_cleanup(ccnl);
+    cache->policy = policy ? policy : &CCNL_DEFAULT_CACHE_POLICY;
+    // the counters describe the policy in use, not its predecessors
+    memset(&cache->stats, 0, sizeof(cache->stats));
+
+    if (cache->policy == &ccnl_cache_2q && ccnl->max_cache_entries > 0) {
+        // the 2Q paper suggests |A1in| = 25% and |A1out| = 50% of the cache
+        cache->qmax = ccnl->max_cache_entries / 4;
+        cache->ghostsize = ccnl->max_cache_entries / 2 + 1;
+        cache->ghostring = (struct ccnl_hlink_s *) ccnl_calloc(
+                               cache->ghostsize, sizeof(struct ccnl_hlink_s));
+
+        if (!cache->ghostring) {
+            cache->ghostsize = 0;
+        }
+    }
+
+    // (re)queue content which is already in the store
+    for (c = ccnl->contents; c; c = c->next) {
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            cache->policy->insert(ccnl, c);
+        }
+    }
+
+    DEBUGMSG(1, "ccnl_cache_init: policy=%s\n", cache->policy->name);
+    return 0;
+}
+
+void ccnl_cache_cleanup(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_cache_s *cache = &ccnl->cache;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        while (cache->q[i].head) {
+            cache_q_unlink(cache->q[i].head);
+        }
+    }
+
+    ccnl_htab_free(&cache->ghost);
+    ccnl_free(cache->ghostring);
+    cache->ghostring = NULL;
+    cache->ghostsize = cache->ghostpos = 0;
+    cache->policy = NULL;
+}
+
+void ccnl_cache_insert(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    if (!ccnl->cache.policy) {
+        ccnl_cache_init(ccnl, NULL);
+    }
+
+    ccnl->cache.stats.insertions++;
+
+    // c may have been queued already by the lazy ccnl_cache_init() above
+    if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC) && !c->queue) {
+        ccnl->cache.policy->insert(ccnl, c);
+    }
+}
+
+void ccnl_cache_hit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    ccnl->cache.stats.hits++;
+
+    if (c->queue) {
+        ccnl->cache.policy->hit(ccnl, c);
+    }
+}
+
+void ccnl_cache_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    (void) ccnl; /* unused */
+
+    if (c->queue) {
+        cache_q_unlink(c);
+    }
+}
+
+struct ccnl_content_s *ccnl_cache_victim(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_content_s *c;
+
+    if (!ccnl->cache.policy) {
+        return NULL;
+    }
+
+    c = ccnl->cache.policy->victim(ccnl);
+
+    if (c) {
+        ccnl->cache.stats.evictions++;
+    }
+
+    return c;
+}
+
+void ccnl_cache_print_stats(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_cache_s *cache = &ccnl->cache;
+    unsigned long lookups = cache->stats.hits + cache->stats.misses;
+
+    printf("cache policy=%s entries=%d/%d\n",
+           cache->policy ? cache->policy->name : "none",
+           ccnl->contentcnt, ccnl->max_cache_entries);
+    printf("  hits=%lu misses=%lu hitratio=%lu%%\n",
+           cache->stats.hits, cache->stats.misses,
+           lookups ? (100 * cache->stats.hits) / lookups : 0);
+    printf("  insertions=%lu evictions=%lu\n",
+           cache->stats.insertions, cache->stats.evictions);
+}
+
+// eof
@@ -62,6 +62,83 @@ ccnl_prefix_to_path(struct ccnl_prefix_s *pr)
     return prefix_buf;
 }
 
+// ----------------------------------------------------------------------
+
+#ifdef CCNL_HEAP_STATS
+
+struct ccnl_heap_stats_s ccnl_heap_stats;
+
+// every block is prefixed with its size, padded for any alignment
+union ccnl_heap_hdr_u {
+    size_t size;
+    double align;
+};
+
+void *ccnl_heap_malloc(size_t s)
+{
+    union ccnl_heap_hdr_u *h = malloc(sizeof(*h) + s);
+
+    if (!h) {
+        return NULL;
+    }
+
+    h->size = s;
+    ccnl_heap_stats.allocs++;
+    ccnl_heap_stats.inuse += s;
+
+    if (ccnl_heap_stats.inuse > ccnl_heap_stats.peak) {
+        ccnl_heap_stats.peak = ccnl_heap_stats.inuse;
+    }
+
+    return h + 1;
+}
+
+void *ccnl_heap_calloc(size_t n, size_t s)
+{
+    void *p = ccnl_heap_malloc(n * s);
+
+    if (p) {
+        memset(p, 0, n * s);
+    }
+
+    return p;
+}
+
+void *ccnl_heap_realloc(void *p, size_t s)
+{
+    union ccnl_heap_hdr_u *h;
+    void *p2;
+
+    if (!p) {
+        return ccnl_heap_malloc(s);
+    }
+
+    h = (union ccnl_heap_hdr_u *) p - 1;
+    p2 = ccnl_heap_malloc(s);
+
+    if (p2) {
+        memcpy(p2, p, h->size < s ? h->size : s);
+        ccnl_heap_free(p);
+    }
+
+    return p2;
+}
+
+void ccnl_heap_free(void *p)
+{
+    union ccnl_heap_hdr_u *h;
+
+    if (!p) {
+        return;
+    }
+
+    h = (union ccnl_heap_hdr_u *) p - 1;
+    ccnl_heap_stats.inuse -= h->size;
+    free(h);
+}
+
+#endif // CCNL_HEAP_STATS
+
 #endif
 
 // eof
@@ -28,6 +28,7 @@
 #include "ccnl-includes.h"
 #include "ccnl-core.h"
 #include "ccnl-ext.h"
+#include "ccnl-platform.h"
 #include "ccnx.h"
 
 
@@ -93,7 +94,7 @@ void ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf, int ifndx,
 
     e->ifndx = ifndx;
     memcpy(&e->dest, dst, sizeof(*dst));
-    ccnl_free(e->bigpkt);
+    ccnl_buf_free(e->bigpkt);
     e->bigpkt = buf;
     e->sendoffs = 0;
 }
@@ -218,7 +219,7 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     if (datalen >= e->bigpkt->datalen) { // fits in a single fragment
         buf->data[flagoffs + e->flagwidth - 1] =
             CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     }
     else if (e->sendoffs == 0) { // this is the start fragment
@@ -226,7 +227,7 @@ ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
     }
     else if (datalen >= (e->bigpkt->datalen - e->sendoffs)) { // the end
         buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
+        ccnl_buf_free(e->bigpkt);
         e->bigpkt = NULL;
     }
     else
@@ -303,7 +304,7 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     // patch flag field:
     if (datalen >= fr->bigpkt->datalen) { // single
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_SINGLE;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     }
     else if (fr->sendoffs == 0) { // start
@@ -311,7 +312,7 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     }
     else if (datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { // end
         buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(fr->bigpkt);
+        ccnl_buf_free(fr->bigpkt);
         fr->bigpkt = NULL;
     }
     else {
@@ -363,11 +364,14 @@ int ccnl_frag_nomorefragments(struct ccnl_frag_s *e)
     return e->bigpkt->datalen <= e->sendoffs;
 }
 
+static void frag_drop_partial(struct ccnl_frag_s *e);
+
 void ccnl_frag_destroy(struct ccnl_frag_s *e)
 {
     if (e) {
-        ccnl_free(e->bigpkt);
-        ccnl_free(e->defrag);
+        ccnl_rem_timer(e->gaptimer);
+        ccnl_buf_free(e->bigpkt);
+        frag_drop_partial(e);
         ccnl_free(e);
     }
 }
@@ -389,37 +393,90 @@ void serialFragPDU_init(struct serialFragPDU_s *s)
     s->ourseqwidth = s->ourlosswidth = s->yourseqwidth = sizeof(int);
 }
 
-void ccnl_frag_RX_serialfragment(RX_datagram callback,
-                                 struct ccnl_relay_s *relay, struct ccnl_face_s *from,
-                                 struct serialFragPDU_s *s)
+static void frag_drop_partial(struct ccnl_frag_s *e)
 {
-    struct ccnl_buf_s *buf = NULL;
-    struct ccnl_frag_s *e = from->frag;
-    DEBUGMSG(8, "  frag %p protocol=%d, flags=%04x, seq=%d (%d)\n", (void *) e,
-             e->protocol, s->flags, s->ourseq, e->recvseq);
+    int i;
+
+    if (e->defrag) {
+        DEBUGMSG(18, "    dropping %d bytes of a partial packet\n",
+                 e->defraglen);
+        e->stats.aborted++;
+        ccnl_buf_free(e->defrag);
+        e->defrag = NULL;
+    }
+
+    e->defraglen = 0;
+
+    for (i = 0; i < CCNL_FRAG_REORDER_WINDOW; i++) {
+        if (e->held[i].buf) {
+            e->stats.dropped++;
+            ccnl_buf_free(e->held[i].buf);
+            e->held[i].buf = NULL;
+        }
+    }
+
+    e->heldcnt = 0;
+}
+
+// append to the partial packet; the buffer doubles when full, so every
+// byte is copied once (amortized) instead of once per later fragment
+static int frag_append(struct ccnl_frag_s *e, unsigned char *data, int len)
+{
+    if (!e->defrag || e->defraglen + len > e->defrag->datalen) {
+        unsigned int size = e->defrag ? e->defrag->datalen : 0;
+        struct ccnl_buf_s *buf;
+
+        if (size < CCNL_BUF_SLAB_LARGE) {
+            size = CCNL_BUF_SLAB_LARGE;
+        }
+
+        while (size < e->defraglen + len) {
+            size <<= 1;
+        }
+
+        buf = ccnl_buf_new(NULL, size);
+
+        if (!buf) {
+            return -1;
+        }
 
-    if (e->recvseq != s->ourseq) {
-        // should increase error counter here
         if (e->defrag) {
-            DEBUGMSG(17, "  >> seqnum mismatch (%d/%d), dropped defrag buf\n",
-                     s->ourseq, e->recvseq);
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
+            memcpy(buf->data, e->defrag->data, e->defraglen);
+            ccnl_buf_free(e->defrag);
         }
+
+        e->defrag = buf;
     }
 
-    switch (s->flags & (CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST)) {
+    memcpy(e->defrag->data + e->defraglen, data, len);
+    e->defraglen += len;
+    return 0;
+}
+
+// handles the fragment with sequence number recvseq
+static void frag_consume(RX_datagram callback, struct ccnl_relay_s *relay,
+                         struct ccnl_face_s *from, unsigned int flags,
+                         unsigned char *data, int len)
+{
+    struct ccnl_frag_s *e = from->frag;
+    struct ccnl_buf_s *buf;
+    unsigned char *pkt;
+    int pktlen;
+
+    switch (flags & (CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST)) {
         case CCNL_DTAG_FRAG_FLAG_SINGLE: // single packet
             DEBUGMSG(17, "  >> single fragment\n");
 
             if (e->defrag) {
                 DEBUGMSG(18, "    had to drop defrag buf\n");
-                ccnl_free(e->defrag);
+                e->stats.aborted++;
+                ccnl_buf_free(e->defrag);
                 e->defrag = NULL;
+                e->defraglen = 0;
             }
 
             // no need to copy the buffer:
-            callback(relay, from, &s->content, &s->contlen);
+            callback(relay, from, &data, &len);
             return;
 
         case CCNL_DTAG_FRAG_FLAG_FIRST: // start of fragment sequence
@@ -427,69 +484,218 @@ void ccnl_frag_RX_serialfragment(RX_datagram callback,
 
             if (e->defrag) {
                 DEBUGMSG(18, "    had to drop defrag buf\n");
-                ccnl_free(e->defrag);
+                e->stats.aborted++;
+                e->defraglen = 0; // keep the buffer for the new series
             }
 
-            e->defrag = ccnl_buf_new(s->content, s->contlen);
-            break;
+            if (frag_append(e, data, len) < 0) {
+                goto Abort;
+            }
+
+            return;
 
         case CCNL_DTAG_FRAG_FLAG_LAST: // end of fragment sequence
-            DEBUGMSG(17, "  >> last fragment of a series\n");
+        case CCNL_DTAG_FRAG_FLAG_MID:  // fragment in the middle of a squence
+        default:
+            DEBUGMSG(17, "  >> %s fragment of a series\n",
+                     flags & CCNL_DTAG_FRAG_FLAG_LAST ? "last" : "middle");
 
-            if (!e->defrag) {
-                break;
+            if (!e->defrag) { // we missed the start
+                e->stats.dropped++;
+                return;
             }
 
-            buf = ccnl_buf_new(NULL, e->defrag->datalen + s->contlen);
+            if (frag_append(e, data, len) < 0) {
+                goto Abort;
+            }
 
-            if (buf) {
-                memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-                memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
+            if (!(flags & CCNL_DTAG_FRAG_FLAG_LAST)) {
+                return;
             }
 
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
             break;
+    }
 
-        case CCNL_DTAG_FRAG_FLAG_MID:  // fragment in the middle of a squence
-        default:
-            DEBUGMSG(17, "  >> fragment in the middle of a series\n");
-
-            if (!e->defrag) {
-                break;
-            }
+    // the partial packet is complete: hand it up, start afresh
+    buf = e->defrag;
+    pkt = buf->data;
+    pktlen = e->defraglen;
+    e->defrag = NULL;
+    e->defraglen = 0;
+    e->stats.reassembled++;
+
+    DEBUGMSG(1, "  >> reassembled fragment is %d bytes\n", pktlen);
+    callback(relay, from, &pkt, &pktlen);
+    ccnl_buf_free(buf);
+    return;
+
+Abort:
+    e->stats.aborted++;
+    ccnl_buf_free(e->defrag);
+    e->defrag = NULL;
+    e->defraglen = 0;
+}
 
-            buf = ccnl_buf_new(NULL, e->defrag->datalen + s->contlen);
+// delivers the held fragments which continue at recvseq
+static void frag_splice_held(RX_datagram callback, struct ccnl_relay_s *relay,
+                             struct ccnl_face_s *from)
+{
+    struct ccnl_frag_s *e = from->frag;
+    struct ccnl_frag_held_s *h;
+    struct ccnl_buf_s *buf;
 
-            if (buf) {
-                memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-                memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
-                ccnl_free(e->defrag);
-                e->defrag = buf;
-                buf = NULL;
-            }
-            else {
-                ccnl_free(e->defrag);
-                e->defrag = NULL;
-            }
+    for (;;) {
+        h = e->held + (e->recvseq & (CCNL_FRAG_REORDER_WINDOW - 1));
 
+        if (!h->buf || h->seq != e->recvseq) {
             break;
+        }
+
+        buf = h->buf;
+        h->buf = NULL;
+        e->heldcnt--;
+        frag_consume(callback, relay, from, h->flags, buf->data, buf->datalen);
+        ccnl_buf_free(buf);
+        e->recvseq = (e->recvseq + 1) & e->recvmask;
+    }
+}
+
+// gives up on the gaps before the held fragments: the partial packet a
+// gap falls into is lost, the held fragments are delivered in order and
+// recvseq ends up behind the last of them
+static void frag_skip_gaps(RX_datagram callback, struct ccnl_relay_s *relay,
+                           struct ccnl_face_s *from)
+{
+    struct ccnl_frag_s *e = from->frag;
+
+    while (e->heldcnt > 0) {
+        DEBUGMSG(17, "  >> giving up on fragment %d\n", e->recvseq);
+
+        if (e->defrag) {
+            e->stats.aborted++;
+            ccnl_buf_free(e->defrag);
+            e->defrag = NULL;
+            e->defraglen = 0;
+        }
+
+        e->recvseq = (e->recvseq + 1) & e->recvmask;
+        frag_splice_held(callback, relay, from);
+    }
+}
+
+// the gap timer expired: what is held now will not be completed anymore
+static void frag_gap_timeout(void *relay, void *face)
+{
+    struct ccnl_face_s *from = (struct ccnl_face_s *) face;
+    struct ccnl_frag_s *e = from->frag;
+
+    e->gaptimer = NULL;
+    frag_skip_gaps(e->rxcb, (struct ccnl_relay_s *) relay, from);
+}
+
+void ccnl_frag_RX_serialfragment(RX_datagram callback,
+                                 struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                                 struct serialFragPDU_s *s)
+{
+    struct ccnl_frag_s *e = from->frag;
+    struct ccnl_frag_held_s *h;
+    unsigned int mask, dist;
+
+    DEBUGMSG(8, "  frag %p protocol=%d, flags=%04x, seq=%d (%d)\n", (void *) e,
+             e->protocol, s->flags, s->ourseq, e->recvseq);
+
+    // sequence numbers wrap around at the width of the field
+    mask = s->ourseqwidth >= sizeof(int) ? ~0u
+           : (1u << (8 * s->ourseqwidth)) - 1;
+    dist = (s->ourseq - e->recvseq) & mask;
+    e->recvmask = mask;
+    e->rxcb = callback;
+
+    if (dist > 0 && dist < CCNL_FRAG_REORDER_WINDOW) {
+        // ahead, but within the window: park it until the gap is filled
+        h = e->held + (s->ourseq & (CCNL_FRAG_REORDER_WINDOW - 1));
+
+        if (h->buf) { // a duplicate
+            e->stats.dropped++;
+            return;
+        }
+
+        h->buf = ccnl_buf_new(s->content, s->contlen);
+
+        if (!h->buf) {
+            e->stats.dropped++;
+            return;
+        }
+
+        h->seq = s->ourseq;
+        h->flags = s->flags;
+        e->heldcnt++;
+        e->stats.reordered++;
+
+        if (!e->gaptimer) {
+            e->gaptimer = ccnl_set_timer(CCNL_FRAG_REORDER_TIMEOUT,
+                                         frag_gap_timeout, relay, from);
+        }
+
+        return;
+    }
+
+    if (dist != 0) {
+        if (dist > mask - CCNL_FRAG_REORDER_WINDOW) {
+            // slightly behind: a duplicate or a straggler we gave up on
+            DEBUGMSG(17, "  >> late fragment (%d/%d), dropped\n",
+                     s->ourseq, e->recvseq);
+            e->stats.dropped++;
+            return;
+        }
+
+        // far off: fragments were lost (or the peer restarted), deliver
+        // what is held and resync
+        DEBUGMSG(17, "  >> seqnum mismatch (%d/%d), resync\n",
+                 s->ourseq, e->recvseq);
+        frag_skip_gaps(callback, relay, from);
+
+        if (e->defrag) {
+            e->stats.aborted++;
+            ccnl_buf_free(e->defrag);
+            e->defrag = NULL;
+            e->defraglen = 0;
+        }
+
+        e->recvseq = s->ourseq;
+    }
+
+    frag_consume(callback, relay, from, s->flags, s->content, s->contlen);
+    e->recvseq = (e->recvseq + 1) & mask;
+
+    // splice in the fragments which were waiting for this one
+    frag_splice_held(callback, relay, from);
+
+    if (!e->heldcnt && e->gaptimer) {
+        ccnl_rem_timer(e->gaptimer);
+        e->gaptimer = NULL;
     }
 
-    // FIXME: we should only bump recvseq if s->ourseq is ahead, or 0
-    e->recvseq = s->ourseq + 1;
     DEBUGMSG(1, ">>> seq from %d to %d (w=%d)\n", s->ourseq, e->recvseq,
              s->ourseqwidth);
+}
 
-    if (buf) {
-        unsigned char *frag = buf->data;
-        int fraglen = buf->datalen;
-        DEBUGMSG(1, "  >> reassembled fragment is %d bytes\n", buf->datalen);
-        callback(relay, from, &frag, &fraglen);
-        ccnl_free(buf);
-    }
+void ccnl_frag_print_stats(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_face_s *f;
 
-    DEBUGMSG(1, "leaving function\n");
+    for (f = ccnl->faces; f; f = f->next) {
+        if (!f->frag) {
+            continue;
+        }
+
+        printf("face %d: frag proto=%d mtu=%d recvseq=%u partial=%u\n"
+               "  reassembled=%lu reordered=%lu dropped=%lu aborted=%lu\n",
+               f->faceid, f->frag->protocol, f->frag->mtu, f->frag->recvseq,
+               f->frag->defraglen, f->frag->stats.reassembled,
+               f->frag->stats.reordered, f->frag->stats.dropped,
+               f->frag->stats.aborted);
+    }
 }
 
 // ----------------------------------------------------------------------
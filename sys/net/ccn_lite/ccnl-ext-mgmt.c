@@ -367,14 +367,15 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     unsigned char *buf;
     int buflen, num, typ;
     struct ccnl_prefix_s *p = NULL;
-    unsigned char *action, *faceid;
+    unsigned char *action, *faceid, *strategy;
+    struct ccnl_strategy_s *s = NULL;
     char *cp = "prefixreg cmd failed";
     int rc = -1;
     //variables for answer
     int len = 0, len2, len3;
 
     DEBUGMSG(1, "ccnl_mgmt_prefixreg\n");
-    action = faceid = NULL;
+    action = faceid = strategy = NULL;
 
     buf = prefix->comp[3];
     buflen = prefix->complen[3];
@@ -465,19 +466,30 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
 
         extractStr(action, CCN_DTAG_ACTION);
         extractStr(faceid, CCN_DTAG_FACEID);
+        extractStr(strategy, CCNL_DTAG_STRATEGY);
 
         if (consume(typ, num, &buf, &buflen, 0, 0) < 0) {
             goto Bail;
         }
     }
 
-    // should (re)verify that action=="prefixreg"
+    if (strategy) {
+        s = ccnl_strategy_by_name((char *) strategy);
+
+        if (!s) {
+            DEBUGMSG(1, "mgmt: unknown strategy '%s'\n", strategy);
+            cp = "prefixreg cmd failed: unknown strategy";
+            goto Bail;
+        }
+    }
+
     if (faceid && p->compcnt > 0) {
         struct ccnl_face_s *f;
-        struct ccnl_forward_s *fwd, **fwd2;
         int fi = strtol((const char *)faceid, NULL, 0);
+        int unreg = action && !strcmp((char *) action, "prefixunreg");
 
-        DEBUGMSG(1, "mgmt: adding prefix %s to faceid='%s'='%d'\n",
+        DEBUGMSG(1, "mgmt: %s prefix %s to faceid='%s'='%d'\n",
+                 unreg ? "removing" : "adding",
                  ccnl_prefix_to_path(p), faceid, fi);
 
         for (f = ccnl->faces; f && f->faceid != fi; f = f->next) {
@@ -490,23 +502,28 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         }
 
         DEBUGMSG(1, "Face %s found! ifndx=%d\n", faceid, f->ifndx);
-        fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
 
-        if (!fwd) {
-            goto Bail;
-        }
+        if (unreg) {
+            cp = "prefixunreg cmd failed";
 
-        fwd->prefix = ccnl_prefix_clone(p);
-        fwd->face = f;
-        fwd2 = &ccnl->fib;
+            if (ccnl_fib_remove(ccnl, p, f) < 0) {
+                goto Bail;
+            }
 
-        while (*fwd2) {
-            fwd2 = &((*fwd2)->next);
+            cp = "prefixunreg cmd worked";
         }
+        else {
+            if (!ccnl_fib_add(ccnl, p, f, CCNL_FIB_DEFAULT_METRIC)) {
+                goto Bail;
+            }
 
-        *fwd2 = fwd;
+            // the strategy belongs to the prefix, not to this next hop
+            if (s && ccnl_fib_set_strategy(ccnl, p, s) < 0) {
+                goto Bail;
+            }
 
-        cp = "prefixreg cmd worked";
+            cp = "prefixreg cmd worked";
+        }
     }
     else {
         DEBUGMSG(1, "mgmt: ignored prefixreg faceid=%s\n", faceid);
@@ -548,6 +565,7 @@ Bail:
     /*END ANWER*/
     ccnl_free(faceid);
     ccnl_free(action);
+    ccnl_free(strategy);
     free_prefix(p);
 
     DEBUGMSG(1, "data='%s' faceid=%d cp='%s'\n", orig->data, from->faceid, cp);
@@ -569,7 +587,7 @@ static int ccnl_mgmt_handle(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     if (!strcmp(cmd, "newface")) {
         DEBUGMSG(1, "ccnl_mgmt_newface msg\n");
         ccnl_mgmt_newface(ccnl, orig, prefix, from);
-    } else if (!strcmp(cmd, "prefixreg")) {
+    } else if (!strcmp(cmd, "prefixreg") || !strcmp(cmd, "prefixunreg")) {
         DEBUGMSG(1, "ccnl_mgmt_prefixreg msg\n");
         ccnl_mgmt_prefixreg(ccnl, orig, prefix, from);
     } else {
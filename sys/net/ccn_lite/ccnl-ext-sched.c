@@ -0,0 +1,237 @@
+/*
+ * @f ccnl-ext-sched.c
+ * @b CCN lite extension, token bucket schedulers for faces and interfaces
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * A queue owner announces every packet it enqueued with ccnl_sched_RTS()
+ * ("request to send"). The scheduler answers with one call of the cts
+ * ("clear to send") callback per packet, right away as long as the bucket
+ * holds a token, otherwise from a timer once the bucket has been refilled
+ * at the configured rate. The bucket holds at most 'burst' tokens, so a
+ * face which was idle may send that many packets back to back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-platform.h"
+
+struct ccnl_sched_s {
+    void (*cts)(void *aux1, void *aux2);
+    void *aux1, *aux2;  // handed to cts, as given to the last RTS
+    int rate;           // packets per second, 0: no pacing
+    int burst;          // bucket size
+    double tokens;
+    double last;        // time of the last refill
+    int pending;        // packets announced but not yet cleared
+    void *timer;
+    struct ccnl_sched_stats_s {
+        unsigned long sent, deferred;
+        unsigned long notimer;  // timer pool was full, sent unpaced
+    } stats;
+};
+
+static void sched_run(struct ccnl_sched_s *s);
+
+static void sched_wakeup(void *aux1, void *aux2)
+{
+    (void) aux2; /* unused */
+
+    struct ccnl_sched_s *s = (struct ccnl_sched_s *) aux1;
+
+    s->timer = NULL;
+    sched_run(s);
+}
+
+static void sched_refill(struct ccnl_sched_s *s)
+{
+    double now = CCNL_NOW();
+
+    s->tokens += (now - s->last) * s->rate;
+    s->last = now;
+
+    if (s->tokens > s->burst) {
+        s->tokens = s->burst;
+    }
+}
+
+static void sched_run(struct ccnl_sched_s *s)
+{
+    if (s->rate > 0) {
+        sched_refill(s);
+    }
+
+    while (s->pending > 0) {
+        if (s->rate > 0) {
+            if (s->tokens < 1) {
+                break;
+            }
+
+            s->tokens -= 1;
+        }
+
+        s->pending--;
+        s->stats.sent++;
+        s->cts(s->aux1, s->aux2);
+    }
+
+    if (s->pending > 0 && !s->timer) {
+        // sleep until the next token has trickled in
+        int usec = (int)((1 - s->tokens) * 1000000 / s->rate) + 1;
+
+        s->timer = ccnl_set_timer(usec, sched_wakeup, s, NULL);
+
+        if (s->timer) {
+            s->stats.deferred++;
+            return;
+        }
+
+        // the pool is shared with all other timers: rather exceed the
+        // rate than leave the queue waiting for an unrelated RTS
+        DEBUGMSG(1, "sched: no free timer, sending %d packets unpaced\n",
+                 s->pending);
+        s->stats.notimer++;
+
+        while (s->pending > 0) {
+            s->pending--;
+            s->stats.sent++;
+            s->cts(s->aux1, s->aux2);
+        }
+    }
+}
+
+struct ccnl_sched_s *
+ccnl_sched_new(void (*cts)(void *aux1, void *aux2), int rate, int burst)
+{
+    struct ccnl_sched_s *s;
+
+    s = (struct ccnl_sched_s *) ccnl_calloc(1, sizeof(struct ccnl_sched_s));
+
+    if (!s) {
+        return NULL;
+    }
+
+    s->cts = cts;
+    ccnl_sched_set_rate(s, rate, burst);
+    return s;
+}
+
+void ccnl_sched_set_rate(struct ccnl_sched_s *s, int rate, int burst)
+{
+    if (!s) {
+        return;
+    }
+
+    s->rate = rate > 0 ? rate : 0;
+    s->burst = burst > 0 ? burst : 1;
+    s->tokens = s->burst;
+    s->last = CCNL_NOW();
+
+    if (s->timer) { // pending packets may go out at the new rate now
+        ccnl_rem_timer(s->timer);
+        s->timer = NULL;
+        sched_run(s);
+    }
+}
+
+void ccnl_sched_RTS(struct ccnl_sched_s *s, int cnt, int len,
+                    void *aux1, void *aux2)
+{
+    (void) len; /* unused */
+
+    s->aux1 = aux1;
+    s->aux2 = aux2;
+    s->pending += cnt;
+
+    if (!s->timer) {
+        sched_run(s);
+    }
+}
+
+void ccnl_sched_destroy(struct ccnl_sched_s *s)
+{
+    if (!s) {
+        return;
+    }
+
+    if (s->timer) {
+        ccnl_rem_timer(s->timer);
+    }
+
+    ccnl_free(s);
+}
+
+// ----------------------------------------------------------------------
+// the relay's defaultFaceScheduler and defaultInterfaceScheduler
+
+struct ccnl_sched_s *
+ccnl_sched_face_new(struct ccnl_relay_s *ccnl,
+                    void (*cts)(void *aux1, void *aux2))
+{
+    (void) ccnl; /* unused */
+
+    return ccnl_sched_new(cts, CCNL_FACE_RATE, CCNL_FACE_BURST);
+}
+
+struct ccnl_sched_s *
+ccnl_sched_interface_new(struct ccnl_relay_s *ccnl,
+                         void (*cts)(void *aux1, void *aux2))
+{
+    (void) ccnl; /* unused */
+
+    return ccnl_sched_new(cts, CCNL_IF_RATE, CCNL_IF_BURST);
+}
+
+// ----------------------------------------------------------------------
+
+static void sched_print(struct ccnl_sched_s *s)
+{
+    if (!s) {
+        printf(" (unscheduled)\n");
+        return;
+    }
+
+    printf(" rate=%d/s burst=%d pending=%d sent=%lu deferred=%lu"
+           " notimer=%lu\n", s->rate, s->burst, s->pending, s->stats.sent,
+           s->stats.deferred, s->stats.notimer);
+}
+
+void ccnl_sched_print_stats(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_face_s *f;
+    int i;
+
+    for (i = 0; i < ccnl->ifcount; i++) {
+        struct ccnl_if_s *ifc = ccnl->ifs + i;
+
+        printf("if %d: qlen=%d/%d enqueued=%lu dropped=%lu\n  ", i,
+               ifc->qlen, CCNL_MAX_IF_QLEN, ifc->qstats.enqueued,
+               ifc->qstats.dropped);
+        sched_print(ifc->sched);
+    }
+
+    for (f = ccnl->faces; f; f = f->next) {
+        printf("face %d: qlen=%d/%d enqueued=%lu dropped=%lu dups=%lu\n  ",
+               f->faceid, f->outqlen, CCNL_MAX_FACE_QLEN, f->qstats.enqueued,
+               f->qstats.dropped, f->qstats.dups);
+        sched_print(f->sched);
+    }
+}
+
+// eof
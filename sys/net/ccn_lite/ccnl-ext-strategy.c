@@ -0,0 +1,323 @@
+/*
+ * @f ccnl-ext-strategy.c
+ * @b CCN lite extension, forwarding strategies and next hop measurements
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Every PIT entry remembers the FIB entries (prefix and next hop) it was
+ * sent to. When content satisfies the interest, the entry of the face the
+ * content came from gets an RTT sample and a hit, when the interest is
+ * retransmitted or expires, the entries which stayed silent get a miss.
+ * From this each FIB entry keeps a smoothed RTT (RFC 6298 style) and a
+ * satisfaction ratio (EWMA of hits and misses).
+ *
+ * The strategy is chosen per prefix, see ccnl_fib_set_strategy(), e.g.
+ * by a prefixreg mgmt request which carries CCNL_DTAG_STRATEGY: the
+ * deepest FIB trie node on the interest's name which has one set decides,
+ * CCNL_DEFAULT_STRATEGY otherwise. The relay prints the measurements on
+ * CCNL_RIOT_PRINT_STAT.
+ *
+ * multicast: the interest goes to all next hops sharing the best metric
+ *
+ * best:      the interest goes to the single next hop with the lowest
+ *            srtt / satisfaction, the metric only breaks ties. Every
+ *            CCNL_STRATEGY_PROBE-th interest of a prefix also goes to one
+ *            of the other next hops (round robin) to keep their numbers
+ *            fresh. Retransmissions go to all next hops. With n next
+ *            hops this costs about 1 + 1/CCNL_STRATEGY_PROBE interests
+ *            upstream per interest instead of multicast's n.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+#include "ccnl-platform.h"
+
+#define SAT_MAX 1000 // satisfaction ratio is kept per mille
+
+// ----------------------------------------------------------------------
+// measurements
+
+void ccnl_strategy_fwd_init(struct ccnl_forward_s *fwd)
+{
+    memset(&fwd->stats, 0, sizeof(fwd->stats));
+    fwd->stats.srtt = CCNL_STRATEGY_RTT_INIT;
+    fwd->stats.sat = SAT_MAX / 2; // no opinion yet
+}
+
+static void strategy_rtt_sample(struct ccnl_fwd_stats_s *st, int rtt)
+{
+    if (!st->rttvar) { // first sample
+        st->srtt = rtt;
+        st->rttvar = rtt / 2 + 1;
+        return;
+    }
+
+    st->rttvar += ((st->srtt > rtt ? st->srtt - rtt : rtt - st->srtt)
+                   - st->rttvar) / 4;
+    st->srtt += (rtt - st->srtt) / 8;
+}
+
+// moves o to the records of fwd, fwd == NULL: o is free again
+static void strategy_out_set(struct ccnl_outrec_s *o, struct ccnl_forward_s *fwd)
+{
+    if (o->fwd) {
+        DBL_LINKED_LIST_REMOVE(o->fwd->outrecs, o);
+    }
+
+    o->fwd = fwd;
+
+    if (fwd) {
+        o->prev = NULL;
+        DBL_LINKED_LIST_ADD(fwd->outrecs, o);
+    }
+}
+
+static void strategy_send(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i,
+                          struct ccnl_forward_s *fwd)
+{
+    struct ccnl_outrec_s *o, *slot = NULL;
+    int k;
+
+    for (k = 0; k < CCNL_STRATEGY_MAX_OUT; k++) {
+        o = i->out + k;
+
+        if (o->fwd == fwd) { // sent before: a sample would be ambiguous
+            o->retx = 1;
+            slot = o;
+            break;
+        }
+
+        // a free slot, else the one which waits longest
+        if (!slot || (slot->fwd && (!o->fwd || o->sent < slot->sent))) {
+            slot = o;
+        }
+    }
+
+    if (slot->fwd != fwd) {
+        strategy_out_set(slot, fwd);
+        slot->retx = 0;
+    }
+
+    slot->sent = CCNL_NOW();
+    fwd->stats.sent++;
+    ccnl_face_enqueue(ccnl, fwd->face, ccnl_buf_ref(i->pkt));
+}
+
+void ccnl_strategy_satisfied(struct ccnl_relay_s *ccnl,
+                             struct ccnl_interest_s *i, struct ccnl_face_s *from)
+{
+    int k;
+
+    (void) ccnl; /* unused */
+
+    for (k = 0; k < CCNL_STRATEGY_MAX_OUT; k++) {
+        struct ccnl_outrec_s *o = i->out + k;
+        struct ccnl_fwd_stats_s *st;
+
+        if (!o->fwd || o->fwd->face != from) {
+            continue;
+        }
+
+        st = &o->fwd->stats;
+        st->satisfied++;
+        st->sat += (SAT_MAX - st->sat) / 8;
+
+        if (!o->retx) {
+            strategy_rtt_sample(st, (int)((CCNL_NOW() - o->sent) * 1000000));
+        }
+
+        strategy_out_set(o, NULL);
+    }
+}
+
+void ccnl_strategy_timeout(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    int k;
+
+    (void) ccnl; /* unused */
+
+    for (k = 0; k < CCNL_STRATEGY_MAX_OUT; k++) {
+        struct ccnl_outrec_s *o = i->out + k;
+
+        if (!o->fwd) {
+            continue;
+        }
+
+        o->fwd->stats.missed++;
+        o->fwd->stats.sat -= o->fwd->stats.sat / 8;
+        o->retx = 1; // a late answer still counts, but gives no RTT
+    }
+}
+
+// fwd is about to be freed: drop all references from the PIT
+void ccnl_strategy_forget(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd)
+{
+    (void) ccnl; /* unused */
+
+    while (fwd->outrecs) {
+        strategy_out_set(fwd->outrecs, NULL);
+    }
+}
+
+// i is about to be freed: drop its records from the FIB entries
+void ccnl_strategy_release(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    int k;
+
+    (void) ccnl; /* unused */
+
+    for (k = 0; k < CCNL_STRATEGY_MAX_OUT; k++) {
+        strategy_out_set(i->out + k, NULL);
+    }
+}
+
+// ----------------------------------------------------------------------
+// strategies
+
+// suppress forwarding to origin of interest, except wireless
+static int strategy_usable(struct ccnl_interest_s *i, struct ccnl_forward_s *fwd)
+{
+    return !i->from || fwd->face != i->from
+           || (i->from->flags & CCNL_FACE_FLAGS_REFLECT);
+}
+
+static int multicast_forward(struct ccnl_relay_s *ccnl,
+                             struct ccnl_interest_s *i, struct ccnl_fib_node_s *n)
+{
+    struct ccnl_forward_s *fwd;
+    int metric = 0, hits = 0;
+
+    for (fwd = n->fwd; fwd; fwd = fwd->nodenext) { // sorted by metric
+        if (hits && fwd->metric > metric) {
+            break;
+        }
+
+        if (strategy_usable(i, fwd)) {
+            strategy_send(ccnl, i, fwd);
+            metric = fwd->metric;
+            hits++;
+        }
+    }
+
+    return hits;
+}
+
+struct ccnl_strategy_s ccnl_strategy_multicast = {
+    "multicast", multicast_forward
+};
+
+// lower is better: the expected delay, inflated by the share of misses
+static long long best_cost(struct ccnl_forward_s *fwd)
+{
+    return (long long) fwd->stats.srtt * SAT_MAX / (fwd->stats.sat + 1);
+}
+
+static int best_forward(struct ccnl_relay_s *ccnl,
+                        struct ccnl_interest_s *i, struct ccnl_fib_node_s *n)
+{
+    struct ccnl_forward_s *fwd, *best = NULL;
+    int cnt = 0, k;
+
+    if (i->retries > 0) { // our choice did not answer in time: ask everyone
+        for (fwd = n->fwd; fwd; fwd = fwd->nodenext) {
+            if (strategy_usable(i, fwd)) {
+                strategy_send(ccnl, i, fwd);
+                cnt++;
+            }
+        }
+
+        return cnt;
+    }
+
+    for (fwd = n->fwd; fwd; fwd = fwd->nodenext) { // sorted by metric
+        if (!strategy_usable(i, fwd)) {
+            continue;
+        }
+
+        if (!best || best_cost(fwd) < best_cost(best)) {
+            best = fwd;
+        }
+
+        cnt++;
+    }
+
+    if (!best) {
+        return 0;
+    }
+
+    strategy_send(ccnl, i, best);
+
+    if (cnt < 2 || ++n->probecnt % CCNL_STRATEGY_PROBE) {
+        return 1;
+    }
+
+    // probe one of the others, round robin
+    k = (n->probecnt / CCNL_STRATEGY_PROBE) % (cnt - 1);
+
+    for (fwd = n->fwd; fwd; fwd = fwd->nodenext) {
+        if (fwd != best && strategy_usable(i, fwd) && k-- == 0) {
+            DEBUGMSG(40, "  probing face %d\n", fwd->face->faceid);
+            strategy_send(ccnl, i, fwd);
+            return 2;
+        }
+    }
+
+    return 1;
+}
+
+struct ccnl_strategy_s ccnl_strategy_best = {
+    "best", best_forward
+};
+
+// ----------------------------------------------------------------------
+
+struct ccnl_strategy_s *
+ccnl_strategy_by_name(const char *name)
+{
+    static struct ccnl_strategy_s *strategies[] = {
+        &ccnl_strategy_multicast, &ccnl_strategy_best, NULL
+    };
+    int i;
+
+    for (i = 0; strategies[i]; i++) {
+        if (!strcmp(strategies[i]->name, name)) {
+            return strategies[i];
+        }
+    }
+
+    return NULL;
+}
+
+void ccnl_strategy_print_stats(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_forward_s *fwd;
+
+    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
+        printf("%s face %d: strategy=%s metric=%d\n",
+               ccnl_prefix_to_path(fwd->prefix), fwd->face->faceid,
+               ccnl_fib_strategy(ccnl, fwd->prefix)->name, fwd->metric);
+        printf("  srtt=%dus rttvar=%dus sat=%d%% sent=%lu satisfied=%lu"
+               " missed=%lu\n", fwd->stats.srtt, fwd->stats.rttvar,
+               fwd->stats.sat / 10, fwd->stats.sent, fwd->stats.satisfied,
+               fwd->stats.missed);
+    }
+}
+
+// eof
@@ -27,9 +27,9 @@
 #define CCNL_EXT_H__
 
 #ifdef USE_CCNxDIGEST
-#  define compute_ccnx_digest(buf) SHA256(buf->data, buf->datalen, NULL)
+#  define compute_ccnx_digest(c) ccnl_content_digest(c)
 #else
-#  define compute_ccnx_digest(b) NULL
+#  define compute_ccnx_digest(c) NULL
 #endif
 
 #ifdef USE_FRAG
@@ -70,24 +70,90 @@ int ccnl_frag_RX_CCNx2013(RX_datagram callback, struct ccnl_relay_s *relay,
                           unsigned char **data, int *datalen);
 
 int ccnl_is_fragment(unsigned char *data, int datalen);
+
+void ccnl_frag_print_stats(struct ccnl_relay_s *ccnl);
 #else
 # define ccnl_frag_new(e,u)   NULL
 # define ccnl_frag_destroy(e) do{}while(0)
 # define ccnl_frag_handle_fragment(r,f,data,len)    ccnl_buf_new(data,len)
 # define ccnl_is_fragment(d,l)  0
+# define ccnl_frag_print_stats(r)   do{}while(0)
 #endif // USE_FRAG
 
 // ----------------------------------------------------------------------
 
+// ----------------------------------------------------------------------
+// content store replacement policies (ccnl-ext-cache.c)
+
+extern struct ccnl_cache_policy_s ccnl_cache_lru;
+extern struct ccnl_cache_policy_s ccnl_cache_2q;
+
+struct ccnl_cache_policy_s *ccnl_cache_policy_by_name(const char *name);
+
+int ccnl_cache_init(struct ccnl_relay_s *ccnl,
+                    struct ccnl_cache_policy_s *policy);
+
+void ccnl_cache_cleanup(struct ccnl_relay_s *ccnl);
+
+void ccnl_cache_insert(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+void ccnl_cache_hit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+void ccnl_cache_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
+struct ccnl_content_s *ccnl_cache_victim(struct ccnl_relay_s *ccnl);
+
+void ccnl_cache_print_stats(struct ccnl_relay_s *ccnl);
+
+// ----------------------------------------------------------------------
+// forwarding strategies (ccnl-ext-strategy.c)
+
+extern struct ccnl_strategy_s ccnl_strategy_multicast;
+extern struct ccnl_strategy_s ccnl_strategy_best;
+
+struct ccnl_strategy_s *ccnl_strategy_by_name(const char *name);
+
+void ccnl_strategy_fwd_init(struct ccnl_forward_s *fwd);
+
+void ccnl_strategy_satisfied(struct ccnl_relay_s *ccnl,
+                             struct ccnl_interest_s *i, struct ccnl_face_s *from);
+
+void ccnl_strategy_timeout(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+
+void ccnl_strategy_forget(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd);
+
+void ccnl_strategy_release(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+
+void ccnl_strategy_print_stats(struct ccnl_relay_s *ccnl);
+
 // ----------------------------------------------------------------------
 
 int ccnl_mgmt(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *buf,
               struct ccnl_prefix_s *prefix, struct ccnl_face_s *from);
 
+struct ccnl_prefix_s *ccnl_prefix_clone(struct ccnl_prefix_s *p);
+
 // ----------------------------------------------------------------------
 
-# define ccnl_sched_CTS_done(S,C,L)	do{}while(0)
-# define ccnl_sched_destroy(S)		do{}while(0)
+struct ccnl_sched_s *
+ccnl_sched_new(void (*cts)(void *aux1, void *aux2), int rate, int burst);
+
+void ccnl_sched_set_rate(struct ccnl_sched_s *s, int rate, int burst);
+
+void ccnl_sched_RTS(struct ccnl_sched_s *s, int cnt, int len,
+                    void *aux1, void *aux2);
+
+void ccnl_sched_destroy(struct ccnl_sched_s *s);
+
+struct ccnl_sched_s *
+ccnl_sched_face_new(struct ccnl_relay_s *ccnl,
+                    void (*cts)(void *aux1, void *aux2));
+
+struct ccnl_sched_s *
+ccnl_sched_interface_new(struct ccnl_relay_s *ccnl,
+                         void (*cts)(void *aux1, void *aux2));
+
+void ccnl_sched_print_stats(struct ccnl_relay_s *ccnl);
 
 char *ccnl_prefix_to_path(struct ccnl_prefix_s *pr);
 
@@ -0,0 +1,330 @@
+/*
+ * @f ccnl-fib.c
+ * @b CCN lite, forwarding information base (name component trie)
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * The FIB is a trie with one node per name component. Instead of a child
+ * table per node, all nodes live in one hash table (relay->fib_nodes)
+ * under the hash of the prefix they stand for, so the child of node n for
+ * component c is found by hashing c onto n's hash and checking the
+ * parent pointer. Longest prefix match, insert and delete thus cost
+ * O(name length), independent of the FIB size. Every entry is also on
+ * the doubly linked list of all entries and on that of its face, so
+ * removing an entry or all entries of a face does not search either.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-ext.h"
+
+static struct ccnl_fib_node_s *
+fib_child(struct ccnl_relay_s *ccnl, struct ccnl_fib_node_s *parent,
+          uint32_t h, unsigned char *comp, int complen)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = ccnl_htab_lookup(&ccnl->fib_nodes, h); l; l = ccnl_htab_next(l)) {
+        struct ccnl_fib_node_s *n = (struct ccnl_fib_node_s *) l->obj;
+
+        if (n->parent == parent && n->complen == complen
+            && !memcmp(n->comp, comp, complen)) {
+            return n;
+        }
+    }
+
+    return NULL;
+}
+
+// returns the node for p, creating the missing part of the path if asked to
+static struct ccnl_fib_node_s *
+fib_node(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, int create)
+{
+    struct ccnl_fib_node_s *n = NULL, *child;
+    uint32_t h = CCNL_HASH_INIT;
+    int i;
+
+    for (i = 0; i < p->compcnt; i++) {
+        h = ccnl_hash_component(h, p->comp[i], p->complen[i]);
+        child = fib_child(ccnl, n, h, p->comp[i], p->complen[i]);
+
+        if (!child) {
+            if (!create) {
+                return NULL;
+            }
+
+            child = (struct ccnl_fib_node_s *) ccnl_calloc(1,
+                    sizeof(*child) + p->complen[i]);
+
+            if (!child) {
+                return NULL;
+            }
+
+            child->parent = n;
+            child->complen = p->complen[i];
+            memcpy(child->comp, p->comp[i], p->complen[i]);
+            child->link.hash = h;
+            child->link.obj = child;
+            ccnl_htab_add(&ccnl->fib_nodes, &child->link);
+
+            if (n) {
+                n->childcnt++;
+            }
+        }
+
+        n = child;
+    }
+
+    return n;
+}
+
+// free n and its ancestors as long as they carry neither routes, children
+// nor a strategy
+static void fib_prune(struct ccnl_relay_s *ccnl, struct ccnl_fib_node_s *n)
+{
+    while (n && !n->fwd && !n->childcnt && !n->strategy) {
+        struct ccnl_fib_node_s *parent = n->parent;
+
+        ccnl_htab_remove(&ccnl->fib_nodes, &n->link);
+        ccnl_free(n);
+
+        if (parent) {
+            parent->childcnt--;
+        }
+
+        n = parent;
+    }
+}
+
+struct ccnl_forward_s *
+ccnl_fib_add(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+             struct ccnl_face_s *f, int metric)
+{
+    struct ccnl_fib_node_s *n;
+    struct ccnl_forward_s *fwd, **pp;
+
+    if (p->compcnt <= 0) {
+        return NULL;
+    }
+
+    n = fib_node(ccnl, p, 1);
+
+    if (!n) {
+        return NULL;
+    }
+
+    for (pp = &n->fwd; *pp; pp = &(*pp)->nodenext) {
+        if ((*pp)->face == f) { // known next hop: only update the metric
+            fwd = *pp;
+            *pp = fwd->nodenext;
+            goto Insert;
+        }
+    }
+
+    fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
+
+    if (!fwd) {
+        fib_prune(ccnl, n);
+        return NULL;
+    }
+
+    fwd->prefix = ccnl_prefix_clone(p);
+    fwd->face = f;
+    ccnl_strategy_fwd_init(fwd);
+    fwd->node = n;
+    DBL_LINKED_LIST_ADD(ccnl->fib, fwd);
+
+    if (f->fwd) {
+        f->fwd->faceprev = fwd;
+    }
+
+    fwd->facenext = f->fwd;
+    f->fwd = fwd;
+
+Insert:
+    fwd->metric = metric;
+
+    for (pp = &n->fwd; *pp && (*pp)->metric <= metric; pp = &(*pp)->nodenext);
+
+    fwd->nodenext = *pp;
+    *pp = fwd;
+    return fwd;
+}
+
+void ccnl_fib_remove_entry(struct ccnl_relay_s *ccnl,
+                           struct ccnl_forward_s *fwd)
+{
+    struct ccnl_forward_s **pp;
+
+    // only the next hops of this one prefix
+    for (pp = &fwd->node->fwd; *pp; pp = &(*pp)->nodenext) {
+        if (*pp == fwd) {
+            *pp = fwd->nodenext;
+            break;
+        }
+    }
+
+    DBL_LINKED_LIST_REMOVE(ccnl->fib, fwd);
+
+    if (fwd->faceprev) {
+        fwd->faceprev->facenext = fwd->facenext;
+    }
+    else {
+        fwd->face->fwd = fwd->facenext;
+    }
+
+    if (fwd->facenext) {
+        fwd->facenext->faceprev = fwd->faceprev;
+    }
+
+    ccnl_strategy_forget(ccnl, fwd);
+    fib_prune(ccnl, fwd->node);
+    free_prefix(fwd->prefix);
+    ccnl_free(fwd);
+}
+
+int ccnl_fib_remove(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                    struct ccnl_face_s *f)
+{
+    struct ccnl_fib_node_s *n = fib_node(ccnl, p, 0);
+    struct ccnl_forward_s *fwd;
+
+    if (!n) {
+        return -1;
+    }
+
+    for (fwd = n->fwd; fwd; fwd = fwd->nodenext) {
+        if (fwd->face == f) {
+            ccnl_fib_remove_entry(ccnl, fwd);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+void ccnl_fib_remove_face(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    while (f->fwd) {
+        ccnl_fib_remove_entry(ccnl, f->fwd);
+    }
+}
+
+// longest prefix match: the deepest node on p's path which has next hops
+struct ccnl_fib_node_s *
+ccnl_fib_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p)
+{
+    struct ccnl_fib_node_s *n = NULL, *best = NULL;
+    uint32_t h = CCNL_HASH_INIT;
+    int i;
+
+    for (i = 0; i < p->compcnt; i++) {
+        h = ccnl_hash_component(h, p->comp[i], p->complen[i]);
+        n = fib_child(ccnl, n, h, p->comp[i], p->complen[i]);
+
+        if (!n) {
+            break;
+        }
+
+        if (n->fwd) {
+            best = n;
+        }
+    }
+
+    return best;
+}
+
+// the next shorter prefix of n which has next hops
+struct ccnl_fib_node_s *
+ccnl_fib_parent(struct ccnl_fib_node_s *n)
+{
+    for (n = n->parent; n && !n->fwd; n = n->parent);
+
+    return n;
+}
+
+// s applies to p and all names below it, unless they have their own.
+// s == NULL: p inherits the strategy of its parent again
+int ccnl_fib_set_strategy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                          struct ccnl_strategy_s *s)
+{
+    struct ccnl_fib_node_s *n;
+
+    if (p->compcnt <= 0) {
+        return -1;
+    }
+
+    n = fib_node(ccnl, p, s != NULL);
+
+    if (!n) {
+        return s ? -1 : 0;
+    }
+
+    n->strategy = s;
+    fib_prune(ccnl, n);
+    return 0;
+}
+
+// the strategy of the deepest node on p's path which has one
+struct ccnl_strategy_s *
+ccnl_fib_strategy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p)
+{
+    struct ccnl_fib_node_s *n = NULL;
+    struct ccnl_strategy_s *s = &CCNL_DEFAULT_STRATEGY;
+    uint32_t h = CCNL_HASH_INIT;
+    int i;
+
+    for (i = 0; i < p->compcnt; i++) {
+        h = ccnl_hash_component(h, p->comp[i], p->complen[i]);
+        n = fib_child(ccnl, n, h, p->comp[i], p->complen[i]);
+
+        if (!n) {
+            break;
+        }
+
+        if (n->strategy) {
+            s = n->strategy;
+        }
+    }
+
+    return s;
+}
+
+void ccnl_fib_cleanup(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_hlink_s *l;
+    unsigned int i;
+
+    while (ccnl->fib) {
+        ccnl_fib_remove_entry(ccnl, ccnl->fib);
+    }
+
+    // what is left are nodes which only carry a strategy
+    for (i = 0; i < ccnl->fib_nodes.size; i++) {
+        while ((l = ccnl->fib_nodes.bucket[i])) {
+            struct ccnl_fib_node_s *n = (struct ccnl_fib_node_s *) l->obj;
+
+            ccnl_htab_remove(&ccnl->fib_nodes, l);
+            ccnl_free(n);
+        }
+    }
+
+    ccnl_htab_free(&ccnl->fib_nodes);
+}
+
+// eof
@@ -0,0 +1,188 @@
+/*
+ * @f ccnl-hash.c
+ * @b CCN lite, hashing of names and packets, chained hash tables
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnl.h"
+#include "ccnl-core.h"
+#include "ccnl-hash.h"
+
+#define FNV_PRIME 16777619u
+
+uint32_t ccnl_hash_update(uint32_t h, unsigned char *data, int len)
+{
+    while (len-- > 0) {
+        h ^= *data++;
+        h *= FNV_PRIME;
+    }
+
+    return h;
+}
+
+uint32_t ccnl_hash_component(uint32_t h, unsigned char *comp, int len)
+{
+    unsigned char l[2];
+
+    // the length acts as separator: "/ab/c" and "/a/bc" must differ
+    l[0] = len >> 8;
+    l[1] = len;
+    h = ccnl_hash_update(h, l, sizeof(l));
+    return ccnl_hash_update(h, comp, len);
+}
+
+uint32_t ccnl_prefix_hash(struct ccnl_prefix_s *p, int compcnt)
+{
+    uint32_t h = CCNL_HASH_INIT;
+    int i;
+
+    for (i = 0; i < compcnt && i < p->compcnt; i++) {
+        h = ccnl_hash_component(h, p->comp[i], p->complen[i]);
+    }
+
+    return h;
+}
+
+// ----------------------------------------------------------------------
+
+static inline unsigned int htab_index(struct ccnl_htab_s *t, uint32_t hash)
+{
+    // FNV's low bits are weak, fold the upper half in
+    return (hash ^ (hash >> 16)) & (t->size - 1);
+}
+
+int ccnl_htab_init(struct ccnl_htab_s *t, unsigned int size)
+{
+    unsigned int s = CCNL_HTAB_MIN_SIZE;
+
+    while (s < size) {
+        s <<= 1;
+    }
+
+    t->bucket = (struct ccnl_hlink_s **) ccnl_calloc(s, sizeof(*t->bucket));
+
+    if (!t->bucket) {
+        t->size = 0;
+        return -1;
+    }
+
+    t->size = s;
+    t->cnt = 0;
+    return 0;
+}
+
+void ccnl_htab_free(struct ccnl_htab_s *t)
+{
+    ccnl_free(t->bucket);
+    t->bucket = NULL;
+    t->size = t->cnt = 0;
+}
+
+static void htab_grow(struct ccnl_htab_s *t)
+{
+    struct ccnl_htab_s t2;
+    struct ccnl_hlink_s *l, *next;
+    unsigned int i;
+
+    if (ccnl_htab_init(&t2, t->size << 1) < 0) {
+        return; // keep the old table: longer chains, but still correct
+    }
+
+    for (i = 0; i < t->size; i++) {
+        for (l = t->bucket[i]; l; l = next) {
+            unsigned int j = htab_index(&t2, l->hash);
+            next = l->next;
+            l->next = t2.bucket[j];
+            t2.bucket[j] = l;
+        }
+    }
+
+    t2.cnt = t->cnt;
+    ccnl_free(t->bucket);
+    *t = t2;
+}
+
+void ccnl_htab_add(struct ccnl_htab_s *t, struct ccnl_hlink_s *l)
+{
+    unsigned int i;
+
+    if (!t->bucket && ccnl_htab_init(t, CCNL_HTAB_MIN_SIZE) < 0) {
+        l->next = NULL;
+        return;
+    }
+
+    if (t->cnt >= t->size) {
+        htab_grow(t);
+    }
+
+    i = htab_index(t, l->hash);
+    l->next = t->bucket[i];
+    t->bucket[i] = l;
+    t->cnt++;
+}
+
+void ccnl_htab_remove(struct ccnl_htab_s *t, struct ccnl_hlink_s *l)
+{
+    struct ccnl_hlink_s **pp;
+
+    if (!t->bucket) {
+        return;
+    }
+
+    for (pp = t->bucket + htab_index(t, l->hash); *pp; pp = &(*pp)->next) {
+        if (*pp == l) {
+            *pp = l->next;
+            l->next = NULL;
+            t->cnt--;
+            return;
+        }
+    }
+}
+
+struct ccnl_hlink_s *ccnl_htab_lookup(struct ccnl_htab_s *t, uint32_t hash)
+{
+    struct ccnl_hlink_s *l;
+
+    if (!t->bucket) {
+        return NULL;
+    }
+
+    for (l = t->bucket[htab_index(t, hash)]; l; l = l->next) {
+        if (l->hash == hash) {
+            return l;
+        }
+    }
+
+    return NULL;
+}
+
+struct ccnl_hlink_s *ccnl_htab_next(struct ccnl_hlink_s *l)
+{
+    uint32_t hash = l->hash;
+
+    for (l = l->next; l; l = l->next) {
+        if (l->hash == hash) {
+            return l;
+        }
+    }
+
+    return NULL;
+}
+
+// eof
@@ -0,0 +1,75 @@
+/*
+ * @f ccnl-hash.h
+ * @b CCN lite, hashing of names and packets, chained hash tables
+ *
+ * Copyright (C) 2013, Christian Mehlis, Freie Universität Berlin
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CCNL_HASH_H__
+#define CCNL_HASH_H__
+
+#include <inttypes.h>
+
+#define CCNL_HTAB_MIN_SIZE  16 // initial number of buckets (power of two)
+
+struct ccnl_prefix_s;
+
+// intrusive hash table link: embedded in (or allocated alongside) the
+// object it indexes, so adding an object to a table never mallocs
+struct ccnl_hlink_s {
+    struct ccnl_hlink_s *next;
+    uint32_t hash;
+    void *obj;
+};
+
+struct ccnl_htab_s {
+    struct ccnl_hlink_s **bucket;
+    unsigned int size; // number of buckets, always a power of two
+    unsigned int cnt;  // number of linked entries
+};
+
+// ----------------------------------------------------------------------
+// hashing: FNV-1a, fed one name component at a time, so that the hash
+// of a prefix with n components is an intermediate result of the hash
+// of every longer name below it
+
+#define CCNL_HASH_INIT      2166136261u
+
+uint32_t ccnl_hash_update(uint32_t h, unsigned char *data, int len);
+
+uint32_t ccnl_hash_component(uint32_t h, unsigned char *comp, int len);
+
+// hash of the first compcnt components of p
+uint32_t ccnl_prefix_hash(struct ccnl_prefix_s *p, int compcnt);
+
+// ----------------------------------------------------------------------
+
+int ccnl_htab_init(struct ccnl_htab_s *t, unsigned int size);
+
+void ccnl_htab_free(struct ccnl_htab_s *t);
+
+void ccnl_htab_add(struct ccnl_htab_s *t, struct ccnl_hlink_s *l);
+
+void ccnl_htab_remove(struct ccnl_htab_s *t, struct ccnl_hlink_s *l);
+
+// returns the first link carrying the given hash, NULL if there is none;
+// callers have to verify the object because hashes may collide
+struct ccnl_hlink_s *ccnl_htab_lookup(struct ccnl_htab_s *t, uint32_t hash);
+
+// returns the next link on the same chain carrying the same hash
+struct ccnl_hlink_s *ccnl_htab_next(struct ccnl_hlink_s *l);
+
+#endif /* CCNL_HASH_H__ */
+// eof
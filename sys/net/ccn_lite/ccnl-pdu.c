@@ -205,16 +205,19 @@ int mkInterest(char **namecomp, unsigned int *nonce, unsigned char *out)
     return len;
 }
 
-int
-mkContent(char **namecomp, char *data, int datalen, unsigned char *out)
+static int
+mk_content(char **namecomp, char *data, int datalen, int final,
+           unsigned char *out)
 {
     int len = 0, k;
+    char *last = NULL;
 
     len = mkHeader(out, CCN_DTAG_CONTENTOBJ, CCN_TT_DTAG);   // content
     len += mkHeader(out + len, CCN_DTAG_NAME, CCN_TT_DTAG); // name
 
     while (*namecomp) {
         len += mkHeader(out + len, CCN_DTAG_COMPONENT, CCN_TT_DTAG); // comp
+        last = *namecomp;
         k = strlen(*namecomp);
         len += mkHeader(out + len, k, CCN_TT_BLOB);
         memcpy(out + len, *namecomp++, k);
@@ -224,6 +227,13 @@ mkContent(char **namecomp, char *data, int datalen, unsigned char *out)
 
     out[len++] = 0; // end-of-name
 
+    if (final && last) {
+        // the final block id is the segment component of the last segment
+        len += mkHeader(out + len, CCN_DTAG_SIGNEDINFO, CCN_TT_DTAG);
+        len += mkStrBlob(out + len, CCN_DTAG_FINALBLOCKID, CCN_TT_DTAG, last);
+        out[len++] = 0; // end-of-signedinfo
+    }
+
     len += mkHeader(out + len, CCN_DTAG_CONTENT, CCN_TT_DTAG); // content obj
     len += mkHeader(out + len, datalen, CCN_TT_BLOB);
     memcpy(out + len, data, datalen);
@@ -235,5 +245,17 @@ mkContent(char **namecomp, char *data, int datalen, unsigned char *out)
     return len;
 }
 
+int
+mkContent(char **namecomp, char *data, int datalen, unsigned char *out)
+{
+    return mk_content(namecomp, data, datalen, 0, out);
+}
+
+int
+mkFinalContent(char **namecomp, char *data, int datalen, unsigned char *out)
+{
+    return mk_content(namecomp, data, datalen, 1, out);
+}
+
 #endif /*CCNL_PDU*/
 // eof
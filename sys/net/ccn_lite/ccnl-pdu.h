@@ -28,3 +28,5 @@ int unmkBinaryInt(unsigned char **data, int *datalen, unsigned int *result,
                   unsigned char *width);
 int mkInterest(char **namecomp, unsigned int *nonce, unsigned char *out);
 int mkContent(char **namecomp, char *data, int datalen, unsigned char *out);
+// like mkContent, but marks the object as the last segment (FinalBlockID)
+int mkFinalContent(char **namecomp, char *data, int datalen, unsigned char *out);
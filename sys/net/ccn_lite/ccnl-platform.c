@@ -23,7 +23,9 @@
  *   ccnl_timer_s to the '#ifndef CCNL_LINUXKERNEL' section
  */
 
+#include <limits.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "rtc.h"
@@ -39,7 +41,27 @@ timevaldelta(struct timeval *a, struct timeval *b)
 
 // ----------------------------------------------------------------------
 
-struct ccnl_timer_s *eventqueue;
+// Timers come from a static pool and are kept in a binary min-heap
+// ordered by timeout, so setting and removing a timer is O(log n) and
+// does not touch the allocator. A handle encodes the pool slot and a
+// sequence number: handles are unique, and a stale handle of an expired
+// timer never removes a newer timer which reuses the slot.
+
+#define HANDLE_SLOT_BITS    8
+#define HANDLE_SLOT_MASK    ((1 << HANDLE_SLOT_BITS) - 1)
+// the sequence number takes the bits above the slot, handles stay positive
+#define HANDLE_SEQ_MASK     ((unsigned int) INT_MAX >> HANDLE_SLOT_BITS)
+
+#if CCNL_MAX_TIMERS > HANDLE_SLOT_MASK
+#  error "CCNL_MAX_TIMERS too large for the timer handle encoding"
+#endif
+
+static struct ccnl_timer_s timerpool[CCNL_MAX_TIMERS];
+static struct ccnl_timer_s *eventqueue[CCNL_MAX_TIMERS];
+static int eventcnt;
+static int freeslots[CCNL_MAX_TIMERS];
+static int freecnt = -1; // -1: pool not initialized yet
+static unsigned int handlerseq;
 
 void
 ccnl_get_timeval(struct timeval *tv)
@@ -48,88 +70,171 @@ ccnl_get_timeval(struct timeval *tv)
     rtc_time(tv);
 }
 
-void *
-ccnl_set_timer(int usec, void (*fct)(void *aux1, void *aux2),
-               void *aux1, void *aux2)
+static int
+timer_before(struct ccnl_timer_s *a, struct ccnl_timer_s *b)
 {
-    struct ccnl_timer_s *t, **pp;
-    static int handlercnt;
+    return a->timeout.tv_sec < b->timeout.tv_sec ||
+           (a->timeout.tv_sec == b->timeout.tv_sec &&
+            a->timeout.tv_usec < b->timeout.tv_usec);
+}
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+static void
+timer_place(struct ccnl_timer_s *t, int i)
+{
+    eventqueue[i] = t;
+    t->idx = i;
+}
+
+static void
+timer_sift_up(int i)
+{
+    struct ccnl_timer_s *t = eventqueue[i];
 
-    if (!t) {
-        return 0;
+    while (i > 0 && timer_before(t, eventqueue[(i - 1) / 2])) {
+        timer_place(eventqueue[(i - 1) / 2], i);
+        i = (i - 1) / 2;
     }
 
-    t->fct2 = fct;
-    //gettimeofday(&t->timeout, NULL);
-    rtc_time(&t->timeout);
-    usec += t->timeout.tv_usec;
-    t->timeout.tv_sec += usec / 1000000;
-    t->timeout.tv_usec = usec % 1000000;
-    t->aux1 = aux1;
-    t->aux2 = aux2;
+    timer_place(t, i);
+}
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-        if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-            ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-             (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-            t->next = *pp;
-            t->handler = handlercnt++;
-            *pp = t;
-            return t;
+static void
+timer_sift_down(int i)
+{
+    struct ccnl_timer_s *t = eventqueue[i];
+    int c;
+
+    while ((c = 2 * i + 1) < eventcnt) {
+        if (c + 1 < eventcnt && timer_before(eventqueue[c + 1], eventqueue[c])) {
+            c++;
+        }
+
+        if (!timer_before(eventqueue[c], t)) {
+            break;
         }
+
+        timer_place(eventqueue[c], i);
+        i = c;
     }
 
-    return NULL; // ?
+    timer_place(t, i);
+}
+
+static void
+timer_unlink(struct ccnl_timer_s *t)
+{
+    struct ccnl_timer_s *last;
+    int i = t->idx;
+
+    t->idx = -1;
+    t->handler = 0;
+    freeslots[freecnt++] = t - timerpool;
+
+    if (--eventcnt == i) {
+        return;
+    }
+
+    // move the last timer into the hole and restore the heap order
+    last = eventqueue[eventcnt];
+    timer_place(last, i);
+    timer_sift_up(i);
+    timer_sift_down(last->idx);
 }
 
 void *
 ccnl_set_absolute_timer(struct timeval abstime, void (*fct)(void *aux1, void *aux2),
                         void *aux1, void *aux2)
 {
-    struct ccnl_timer_s *t, **pp;
-    static int handlercnt;
+    struct ccnl_timer_s *t;
+    int slot;
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    if (freecnt < 0) {
+        for (freecnt = 0; freecnt < CCNL_MAX_TIMERS; freecnt++) {
+            freeslots[freecnt] = CCNL_MAX_TIMERS - 1 - freecnt;
+        }
+    }
 
-    if (!t) {
-        return 0;
+    if (!freecnt) {
+        DEBUGMSG(1, "ccnl_set_timer: no free timer\n");
+        return NULL;
     }
 
+    slot = freeslots[--freecnt];
+    t = timerpool + slot;
+    memset(t, 0, sizeof(*t));
     t->fct2 = fct;
     t->timeout = abstime;
     t->aux1 = aux1;
     t->aux2 = aux2;
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-        if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-            ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-             (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-            t->next = *pp;
-            t->handler = handlercnt++;
-            *pp = t;
-            return t;
-        }
+    handlerseq = (handlerseq + 1) & HANDLE_SEQ_MASK;
+
+    if (!handlerseq) { // the sequence number wrapped, 0 is never used
+        handlerseq = 1;
     }
 
-    return NULL; // ?
+    t->handler = (int)((handlerseq << HANDLE_SLOT_BITS) | (slot + 1));
+
+    timer_place(t, eventcnt++);
+    timer_sift_up(t->idx);
+
+    return (void *)(intptr_t) t->handler;
+}
+
+void *
+ccnl_set_timer(int usec, void (*fct)(void *aux1, void *aux2),
+               void *aux1, void *aux2)
+{
+    struct timeval tv;
+
+    //gettimeofday(&tv, NULL);
+    rtc_time(&tv);
+    usec += tv.tv_usec;
+    tv.tv_sec += usec / 1000000;
+    tv.tv_usec = usec % 1000000;
+
+    return ccnl_set_absolute_timer(tv, fct, aux1, aux2);
 }
 
 void
 ccnl_rem_timer(void *h)
 {
-    struct ccnl_timer_s **pp;
+    int handler = (int)(intptr_t) h;
+    int slot = (handler & HANDLE_SLOT_MASK) - 1;
 
     DEBUGMSG(99, "removing time handler %p\n", h);
 
-    for (pp = &eventqueue; *pp; pp = &((*pp)->next)) {
-        if ((void *)*pp == h) {
-            struct ccnl_timer_s *e = *pp;
-            *pp = e->next;
-            ccnl_free(e);
-            break;
-        }
+    if (slot >= 0 && slot < CCNL_MAX_TIMERS
+        && handler && timerpool[slot].handler == handler) {
+        timer_unlink(timerpool + slot);
+    }
+}
+
+void
+ccnl_rem_all_timers(void)
+{
+    while (eventcnt) {
+        timer_unlink(eventqueue[0]);
+    }
+}
+
+struct ccnl_timer_s *
+ccnl_timer_first(void)
+{
+    return eventcnt ? eventqueue[0] : NULL;
+}
+
+void
+ccnl_timer_fire(struct ccnl_timer_s *t)
+{
+    void (*fct)(void *, void *) = t->fct2;
+    void *aux1 = t->aux1, *aux2 = t->aux2;
+
+    // the slot is free before the handler runs: it may set new timers
+    timer_unlink(t);
+
+    if (fct) {
+        fct(aux1, aux2);
     }
 }
 
@@ -28,23 +28,34 @@ double current_time(void);
 // for omnet.
 //
 struct ccnl_timer_s {
-    struct ccnl_timer_s *next;
+    int idx; // position in the timer heap, -1 if not queued
     struct timeval timeout;
-    void (*fct)(char, int);
     void (*fct2)(void *, void *);
-    char node;
-    int intarg;
     void *aux1;
     void *aux2;
-    int handler;
+    int handler; // 0 for a free timer
 };
 
 long timevaldelta(struct timeval *a, struct timeval *b);
 
+// returns an opaque handle for ccnl_rem_timer(), NULL if out of timers
 void *ccnl_set_timer(int usec, void (*fct)(void *aux1, void *aux2),
                void *aux1, void *aux2);
 
+void *ccnl_set_absolute_timer(struct timeval abstime,
+               void (*fct)(void *aux1, void *aux2), void *aux1, void *aux2);
+
+// removing an expired or already removed timer is harmless
 void
 ccnl_rem_timer(void *h);
 
-extern struct ccnl_timer_s *eventqueue;
+void
+ccnl_rem_all_timers(void);
+
+// the timer which expires next, NULL if there is none
+struct ccnl_timer_s *
+ccnl_timer_first(void);
+
+// dequeue t and run its handler
+void
+ccnl_timer_fire(struct ccnl_timer_s *t);
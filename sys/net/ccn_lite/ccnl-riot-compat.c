@@ -61,7 +61,7 @@ int riot_send_msg(uint8_t *buf, uint16_t size, uint16_t to)
     DEBUGMSG(1, "this is a RIOT MSG based connection\n");
     DEBUGMSG(1, "size=%" PRIu16 " to=%" PRIu16 "\n", size, to);
 
-    uint8_t *buf2 = malloc(sizeof(riot_ccnl_msg_t) + size);
+    uint8_t *buf2 = ccnl_malloc(sizeof(riot_ccnl_msg_t) + size);
     if (!buf2) {
         DEBUGMSG(1, "  malloc failed...dorpping msg!\n");
         return 0;
@@ -97,6 +97,15 @@ char *riot_ccnl_event_to_string(ccnl_riot_event_t event)
         case CCNL_RIOT_POPULATE:
             return "RIOT_POPULATE";
 
+        case CCNL_RIOT_MSG_OWNED:
+            return "RIOT_MSG_OWNED";
+
+        case CCNL_RIOT_PRINT_STAT:
+            return "RIOT_PRINT_STAT";
+
+        case CCNL_RIOT_CACHE_POLICY:
+            return "RIOT_CACHE_POLICY";
+
         default:
             return "UNKNOWN";
     }
@@ -27,14 +27,53 @@
 #define CCNL_CONTENT_TIMEOUT		30 // sec
 #define CCNL_INTEREST_TIMEOUT		4  // sec
 #define CCNL_MAX_INTEREST_RETRANSMIT	2
+#define CCNL_INTEREST_RETRANSMIT	1  // sec, doubled after every retransmit
+#define CCNL_RETRANSMIT_SLOTS		8  // sec, > longest retransmit interval
 
 #define CCNL_FACE_TIMEOUT	15 // sec
 
+#define CCNL_MAX_TIMERS		64 // pending ccnl_set_timer() events
+
 #define CCNL_MAX_NAME_COMP	16
 #define CCNL_MAX_IF_QLEN	64
+#define CCNL_MAX_FACE_QLEN	16
+
+// pacing is off by default, e.g. CFLAGS += -DCCNL_IF_RATE=50 turns it on
+#ifndef CCNL_FACE_RATE
+#define CCNL_FACE_RATE		0   // packets/sec per face, 0: no pacing
+#endif
+#define CCNL_FACE_BURST		8
+#ifndef CCNL_IF_RATE
+#define CCNL_IF_RATE		0   // packets/sec per network interface, 0: no pacing
+#endif
+#define CCNL_IF_BURST		8
+
+#define CCNL_FRAG_REORDER_WINDOW	4   // fragments held back, power of 2
+#define CCNL_FRAG_REORDER_TIMEOUT	200000 // usec a gap may stay open, then it is skipped
+
+#define CCNL_CLIENT_WINDOW_INIT	2   // segment interests in flight
+#define CCNL_CLIENT_WINDOW_MAX	8   // must stay below the relay's msg queue
+#define CCNL_CLIENT_RETRIES	3   // per segment
+#define CCNL_CLIENT_RTO_INIT	1000000 // usec
+#define CCNL_CLIENT_RTO_MIN	20000
+#define CCNL_CLIENT_RTO_MAX	4000000
+
+// packet buffers of up to this many data bytes are recycled, not freed:
+#define CCNL_BUF_SLAB_SMALL	32  // nonces, digests
+#define CCNL_BUF_SLAB_LARGE	128 // interests, small content objects
+#define CCNL_BUF_SLAB_KEEP	16  // free buffers kept per size class
+
+#define CCNL_DEFAULT_STRATEGY		ccnl_strategy_best // or ccnl_strategy_multicast
+#define CCNL_STRATEGY_MAX_OUT		4   // next hops remembered per PIT entry
+#define CCNL_STRATEGY_PROBE		16  // best: every n-th interest also probes
+#define CCNL_STRATEGY_RTT_INIT		100000 // usec, assumed for unmeasured hops
 
 #define CCNL_DEFAULT_MAX_CACHE_ENTRIES	0   // means: no content caching
-#define CCNL_MAX_NONCES			256 // for detected dups
+#define CCNL_DEFAULT_CACHE_POLICY	ccnl_cache_lru // or ccnl_cache_2q
+#define CCNL_MAX_NONCES			256 // for detected dups, per filter generation
+#define CCNL_NONCE_TIMEOUT		12  // sec, max lifetime of a filter generation
+#define CCNL_NONCE_BLOOM_BITS		(CCNL_MAX_NONCES * 16) // per generation
+#define CCNL_NONCE_BLOOM_HASHES		4
 
 
 // ----------------------------------------------------------------------
@@ -50,6 +89,7 @@
 #define CCNL_DTAG_DEVNAME	99007 // name of interface (eth0, wlan0)
 #define CCNL_DTAG_DEVFLAGS	99008 //
 #define CCNL_DTAG_MTU		99009 //
+#define CCNL_DTAG_STRATEGY	99010 // prefixreg: forwarding strategy, by name
 
 #define CCNL_DTAG_DEBUGREQUEST  99100 //
 #define CCNL_DTAG_DEBUGACTION   99101 // dump, halt, dump+halt
@@ -51,6 +51,9 @@ typedef enum ccnl_riot_event {
     CCNL_RIOT_MSG = CCNL_RIOT_EVENT_NUMBER_OFFSET + 1,
     CCNL_RIOT_HALT,
     CCNL_RIOT_POPULATE,
+    CCNL_RIOT_MSG_OWNED,    // like CCNL_RIOT_MSG, the relay frees the message
+    CCNL_RIOT_PRINT_STAT,   // the relay prints its statistics
+    CCNL_RIOT_CACHE_POLICY, // content.ptr: policy name, e.g. "2q", a literal
 
     CCNL_RIOT_RESERVED
 } ccnl_riot_event_t;
@@ -79,13 +82,112 @@ typedef enum ccnl_riot_event {
  */
 void ccnl_riot_relay_start(int max_cache_entries);
 
+/**
+ * @return 1 while a thread runs ccnl_riot_relay_start(), 0 otherwise
+ */
+int ccnl_riot_relay_running(void);
+
+/**
+ * @brief  reads len bytes at offset offs of a callback backed object
+ *
+ * @return the number of bytes stored in buf, < 0 on error
+ */
+typedef int (*ccnl_riot_appserver_read_t)(void *arg, unsigned int offs,
+        unsigned char *buf, int len);
+
+/**
+ * @brief  publishes a memory backed object under a name, e.g. "/riot/text"
+ *
+ *         The appserver answers interests for <name>/<n> with the n-th
+ *         chunk of CCNL_RIOT_CHUNK_SIZE bytes, the last chunk carries the
+ *         final block marker. Call before ccnl_riot_appserver_start(), the
+ *         data must stay valid while the appserver runs.
+ *
+ * @param name  c string representation of the object's name
+ * @param data  the object
+ * @param len   its length in bytes
+ *
+ * @return 0 on success, -1 if the name is too long or the table is full
+ */
+int ccnl_riot_appserver_publish(char *name, const unsigned char *data,
+                                unsigned int len);
+
+/**
+ * @brief  publishes an object whose chunks are produced on demand by read
+ *
+ * @see    ccnl_riot_appserver_publish()
+ */
+int ccnl_riot_appserver_publish_cb(char *name, unsigned int len,
+                                   ccnl_riot_appserver_read_t read, void *arg);
+
 /**
  * @brief  starts an appication server, which can repy to ccn interests
  *
+ *         Registers the prefixes of all published objects with the relay
+ *         and serves their chunks. Without published objects a built-in
+ *         test object "/riot/appserver/test" is served.
+ *
  * @param relay_pid the pid of the relay
  */
 void ccnl_riot_appserver_start(int relay_pid);
 
+#ifdef CCNL_BENCH
+/**
+ * @brief  parameters of a ccnl_riot_bench() run
+ */
+typedef struct ccnl_riot_bench_cfg {
+    unsigned int catalogue;     /**< number of distinct content names */
+    unsigned int namelen;       /**< name components, 2..16 */
+    unsigned int zipf;          /**< Zipf exponent * 100, 0: uniform */
+    int cache_entries;          /**< CS size, <= 0: no caching */
+    unsigned int interests;     /**< number of interests to inject */
+    unsigned int contentlen;    /**< payload bytes per content object */
+    unsigned int seed;          /**< PRNG seed, same seed: same workload */
+} ccnl_riot_bench_cfg_t;
+
+/**
+ * @brief  results of a ccnl_riot_bench() run
+ */
+typedef struct ccnl_riot_bench_result {
+    uint32_t usec;              /**< wall clock time of the run */
+    unsigned int interests;     /**< injected */
+    unsigned int answered;      /**< got content back */
+    unsigned int upstream;      /**< reached the producer (CS misses) */
+    unsigned int hit_permille;  /**< CS hit ratio */
+    unsigned int pit_max;       /**< PIT occupancy high-water mark */
+    uint32_t lat_usec[4];       /**< latency p50, p90, p99 and max */
+    unsigned long heap_peak;    /**< relay heap high-water mark in bytes,
+                                     needs CCNL_HEAP_STATS, else 0 */
+} ccnl_riot_bench_result_t;
+
+/**
+ * @brief  loads a private relay instance with a synthetic workload
+ *
+ *         Interests for Zipf distributed names are injected through a
+ *         loopback face, a loopback producer answers all CS misses. The
+ *         workload only depends on cfg, so runs can be compared before
+ *         and after a change to the relay.
+ *
+ * @note   only available with CFLAGS += -DCCNL_BENCH
+ *
+ * @note   the relay code is not reentrant: the buffer slab, the timer
+ *         pool and the heap statistics are shared with the relay thread
+ *         (ccnl_riot_relay_start()), so the benchmark refuses to run while
+ *         it is active
+ *
+ * @return 0 on success, -1 on invalid parameters, lack of memory or a
+ *         running relay thread
+ */
+int ccnl_riot_bench(const ccnl_riot_bench_cfg_t *cfg,
+                    ccnl_riot_bench_result_t *res);
+
+/**
+ * @brief  prints the parameters and results of a benchmark run
+ */
+void ccnl_riot_bench_print(const ccnl_riot_bench_cfg_t *cfg,
+                           const ccnl_riot_bench_result_t *res);
+#endif /* CCNL_BENCH */
+
 /**
  * @}
  */
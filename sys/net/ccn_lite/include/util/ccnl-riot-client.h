@@ -30,15 +30,24 @@
 /**
  * @brief  high level function to fetch a file (all chunks of a file)
  *
+ *         Up to CCNL_CLIENT_WINDOW_MAX segment interests are kept in
+ *         flight (AIMD window), unanswered ones are retransmitted after
+ *         an RTT based timeout. Segments may arrive in any order, they
+ *         are copied to their final place in reply_buf.
+ *
  * @param relay_pid pid of the relay thread
  *
  * @param name c string represenation of the name to fetch e.g. "/riot/test"
  *
  * @param reply_buf buffer for the aswer message from the relay
  *
- * @return the length of the reply message stored in reply_buf
+ * @param reply_buf_size size of reply_buf in bytes
+ *
+ * @return the length of the reply message stored in reply_buf, 0 if a
+ *         segment could not be fetched or does not fit into reply_buf
  */
-int ccnl_riot_client_get(unsigned int relay_pid, char *name, char *reply_buf);
+int ccnl_riot_client_get(unsigned int relay_pid, char *name, char *reply_buf,
+                         int reply_buf_size);
 
 /**
  * @brief   high level function to publish a name, e.g. "/riot/test"
@@ -103,6 +112,15 @@ int ccnl_riot_client_new_face(unsigned int relay_pid, char *type, char *faceid,
 int ccnl_riot_client_register_prefix(unsigned int relay_pid, char *prefix,
         char *faceid, unsigned char *reply_buf);
 
+/**
+ * @brief like ccnl_riot_client_register_prefix(), also sets the forwarding
+ *        strategy of prefix
+ *
+ * @param strategy "multicast" or "best", NULL keeps the current one
+ */
+int ccnl_riot_client_register_prefix_strategy(unsigned int relay_pid,
+        char *prefix, char *faceid, char *strategy, unsigned char *reply_buf);
+
 /**
  * @}
  */
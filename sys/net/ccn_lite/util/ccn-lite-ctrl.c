@@ -100,7 +100,8 @@ mkNewFaceRequest(unsigned char *out, char *macsrc, char *ip4src,
 // ----------------------------------------------------------------------
 
 int
-mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid)
+mkPrefixregRequestStrategy(unsigned char *out, char reg, char *path,
+                           char *faceid, char *strategy)
 {
     int len = 0, len2, len3;
     char *cp;
@@ -129,6 +130,12 @@ mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid)
 
     fwdentry[len3++] = 0; // end-of-prefix
     len3 += mkStrBlob(fwdentry + len3, CCN_DTAG_FACEID, CCN_TT_DTAG, faceid);
+
+    if (strategy) {
+        len3 += mkStrBlob(fwdentry + len3, CCNL_DTAG_STRATEGY, CCN_TT_DTAG,
+                          strategy);
+    }
+
     fwdentry[len3++] = 0; // end-of-fwdentry
 
     // prepare CONTENTOBJ with CONTENT
@@ -148,4 +155,10 @@ mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid)
     return len;
 }
 
+int
+mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid)
+{
+    return mkPrefixregRequestStrategy(out, reg, path, faceid, NULL);
+}
+
 // ----------------------------------------------------------------------
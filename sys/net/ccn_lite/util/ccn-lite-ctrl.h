@@ -20,3 +20,7 @@ int mkNewFaceRequest(unsigned char *out, char *macsrc, char *ip4src,
                      char *host, char *port, char *flags);
 
 int mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid);
+
+// strategy: forwarding strategy for path, NULL: none
+int mkPrefixregRequestStrategy(unsigned char *out, char reg, char *path,
+                               char *faceid, char *strategy);
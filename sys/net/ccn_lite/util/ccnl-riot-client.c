@@ -22,7 +22,10 @@
 #include <stdlib.h>
 
 #include "msg.h"
+#include "thread.h"
+#include "vtimer.h"
 
+#include "ccnx.h"
 #include "ccnl.h"
 #include "ccnl-core.h"
 #include "ccnl-riot-compat.h"
@@ -33,9 +36,100 @@ msg_t mesg, rep;
 
 unsigned char compat_small_buf[PAYLOAD_SIZE];
 
-int ccnl_riot_client_get(unsigned int relay_pid, char *name, char *reply_buf)
+// one outstanding segment interest; it keeps its own interest buffer
+// because the relay reads the payload only after msg_send() returned
+struct ccnl_riot_client_seg_s {
+    int seg;            // -1: slot is free
+    int retries;
+    timex_t sent, deadline;
+    riot_ccnl_msg_t rmsg;
+    unsigned char interest[PAYLOAD_SIZE];
+};
+
+static struct ccnl_riot_client_seg_s client_segs[CCNL_CLIENT_WINDOW_MAX];
+
+static uint32_t client_rto = CCNL_CLIENT_RTO_INIT; // usec
+static int32_t client_srtt = -1, client_rttvar;
+
+static void client_rtt_sample(timex_t sent)
 {
-    char *prefix[CCNL_MAX_NAME_COMP];
+    timex_t now;
+    int32_t rtt, err;
+
+    vtimer_now(&now);
+    now = timex_sub(now, sent);
+    rtt = now.seconds * 1000000 + now.microseconds;
+
+    if (client_srtt < 0) {
+        client_srtt = rtt;
+        client_rttvar = rtt / 2;
+    }
+    else { // RFC 6298, alpha = 1/8, beta = 1/4
+        err = rtt - client_srtt;
+        client_srtt += err / 8;
+        client_rttvar += ((err < 0 ? -err : err) - client_rttvar) / 4;
+    }
+
+    client_rto = client_srtt + 4 * client_rttvar;
+
+    if (client_rto < CCNL_CLIENT_RTO_MIN) {
+        client_rto = CCNL_CLIENT_RTO_MIN;
+    }
+    else if (client_rto > CCNL_CLIENT_RTO_MAX) {
+        client_rto = CCNL_CLIENT_RTO_MAX;
+    }
+}
+
+static void client_send_interest(unsigned int relay_pid, char **prefix,
+                                 int compcnt, struct ccnl_riot_client_seg_s *s)
+{
+    char segment_string[16];
+    msg_t m;
+
+    snprintf(segment_string, sizeof(segment_string), "%d", s->seg);
+    prefix[compcnt] = segment_string;
+    s->rmsg.payload = s->interest;
+    s->rmsg.size = mkInterest(prefix, NULL, s->interest);
+
+    vtimer_now(&s->sent);
+    s->deadline = timex_add(s->sent, timex_set(client_rto / 1000000,
+                                               client_rto % 1000000));
+
+    DEBUGMSG(1, "relay_pid=%u segment=%d interest_len=%d\n", relay_pid,
+             s->seg, (int) s->rmsg.size);
+    m.content.ptr = (char *) &s->rmsg;
+    m.type = CCNL_RIOT_MSG;
+    msg_send(&m, relay_pid, 1);
+}
+
+// segment number of a content name below prefix, -1 if it is not ours
+static int client_segment_of(struct ccnl_prefix_s *p, char **prefix,
+                             int compcnt)
+{
+    char segment_string[16];
+    int k;
+
+    if (p->compcnt != compcnt + 1 || p->complen[compcnt] <= 0
+        || p->complen[compcnt] >= (int) sizeof(segment_string)) {
+        return -1;
+    }
+
+    for (k = 0; k < compcnt; k++) {
+        if (p->complen[k] != (int) strlen(prefix[k])
+            || memcmp(p->comp[k], prefix[k], p->complen[k])) {
+            return -1;
+        }
+    }
+
+    memcpy(segment_string, p->comp[compcnt], p->complen[compcnt]);
+    segment_string[p->complen[compcnt]] = '\0';
+    return atoi(segment_string);
+}
+
+int ccnl_riot_client_get(unsigned int relay_pid, char *name, char *reply_buf,
+                         int reply_buf_size)
+{
+    char *prefix[CCNL_MAX_NAME_COMP + 1];
     char *cp = strtok(name, "/");
     int i = 0;
 
@@ -44,39 +138,124 @@ int ccnl_riot_client_get(unsigned int relay_pid, char *name, char *reply_buf)
         cp = strtok(NULL, "/");
     }
 
-    //prefix[i] = 0; //segment to request
+    prefix[i] = 0; // the segment component is filled in per interest
     prefix[i + 1] = 0;
 
-    int content_len = 0;
+    // AIMD window of outstanding segment interests: grows by one segment
+    // per window of replies, halves on every timeout
+    int window = CCNL_CLIENT_WINDOW_INIT, acked = 0;
+    int next_segment = 0, last_segment = -1, received = 0;
+    int content_len = 0, k, outstanding;
+    struct ccnl_riot_client_seg_s *s;
+    vtimer_t timeout_vt;
 
-    for (int segment = 0; ; segment++) {
-        char segment_string[16]; //max=999\0
-        memset(segment_string, 0, 16);
-        snprintf(segment_string, 16, "%d", segment);
-        prefix[i] = segment_string;
-        int interest_len = mkInterest(prefix, NULL, compat_small_buf);
-        DEBUGMSG(1, "relay_pid=%u interest_len=%d\n", relay_pid, interest_len);
+    for (k = 0; k < CCNL_CLIENT_WINDOW_MAX; k++) {
+        client_segs[k].seg = -1;
+    }
+
+    for (;;) {
+        timex_t now, wait;
+        msg_t rep;
+
+        // fill the window
+        outstanding = 0;
+
+        for (k = 0; k < CCNL_CLIENT_WINDOW_MAX; k++) {
+            outstanding += client_segs[k].seg >= 0;
+        }
 
-        riot_ccnl_msg_t rmsg;
-        rmsg.payload = &compat_small_buf;
-        rmsg.size = interest_len;
+        for (k = 0; k < CCNL_CLIENT_WINDOW_MAX && outstanding < window; k++) {
+            s = client_segs + k;
 
-        msg_t m, rep;
-        m.content.ptr = (char *) &rmsg;
-        m.type = CCNL_RIOT_MSG;
-        msg_send(&m, relay_pid, 1);
+            if (s->seg >= 0 || (last_segment >= 0 && next_segment > last_segment)) {
+                continue;
+            }
+
+            s->seg = next_segment++;
+            s->retries = 0;
+            client_send_interest(relay_pid, prefix, i, s);
+            outstanding++;
+        }
+
+        if (!outstanding) {
+            break; // all segments up to the last one arrived
+        }
+
+        // sleep until a reply arrives or the earliest segment times out
+        s = NULL;
+
+        for (k = 0; k < CCNL_CLIENT_WINDOW_MAX; k++) {
+            if (client_segs[k].seg >= 0 && (!s ||
+                timex_cmp(client_segs[k].deadline, s->deadline) < 0)) {
+                s = client_segs + k;
+            }
+        }
+
+        vtimer_now(&now);
+
+        if (timex_cmp(s->deadline, now) > 0) {
+            wait = timex_sub(s->deadline, now);
+            vtimer_set_msg(&timeout_vt, wait, thread_getpid(), NULL);
+            msg_receive(&rep);
+            vtimer_remove(&timeout_vt);
+        }
+        else {
+            rep.type = MSG_TIMER;
+        }
+
+        if (rep.type == MSG_TIMER) {
+            int lost = 0;
+
+            vtimer_now(&now);
+
+            for (k = 0; k < CCNL_CLIENT_WINDOW_MAX; k++) {
+                s = client_segs + k;
+
+                if (s->seg < 0 || timex_cmp(s->deadline, now) > 0) {
+                    continue;
+                }
+
+                if (++s->retries > CCNL_CLIENT_RETRIES) {
+                    DEBUGMSG(1, "  segment %d timed out, giving up\n", s->seg);
+                    return 0;
+                }
+
+                if (!lost++) { // one congestion signal per expiry
+                    window = window / 2 > 0 ? window / 2 : 1;
+                    acked = 0;
+                    client_rto = client_rto * 2 < CCNL_CLIENT_RTO_MAX ?
+                                 client_rto * 2 : CCNL_CLIENT_RTO_MAX;
+                }
+
+                client_send_interest(relay_pid, prefix, i, s);
+            }
+
+            continue;
+        }
+
+        if (rep.type != CCNL_RIOT_MSG) {
+            continue;
+        }
 
         /* ######################################################################### */
 
-        msg_receive(&rep);
         riot_ccnl_msg_t *rmsg_reply = (riot_ccnl_msg_t *) rep.content.ptr;
 
         unsigned char *data = rmsg_reply->payload;
         int datalen = (int) rmsg_reply->size;
         DEBUGMSG(1, "%d bytes left; msg from=%u '%s'\n", datalen, rep.sender_pid, data);
 
+        int num, typ;
+
+        if (dehead(&data, &datalen, &num, &typ) != 0 || typ != CCN_TT_DTAG
+            || num != CCN_DTAG_CONTENTOBJ) {
+            DEBUGMSG(6, "  not a content object\n");
+            ccnl_free(rmsg_reply);
+            continue;
+        }
+
         int scope = 3, aok = 3, minsfx = 0, maxsfx = CCNL_MAX_NAME_COMP,
-            contlen = 0;
+            contlen = 0, segment;
         struct ccnl_buf_s *buf = 0, *nonce = 0, *ppkd = 0;
         struct ccnl_prefix_s *p = 0;
         unsigned char *content = 0;
@@ -86,19 +265,73 @@ int ccnl_riot_client_get(unsigned int relay_pid, char *name, char *reply_buf)
 
         if (!buf) {
             DEBUGMSG(6, "  parsing error or no prefix\n");
+            ccnl_free(rmsg_reply);
             return 0;
         }
 
-        DEBUGMSG(1, "content_len=%d contlen=%d\n", content_len, contlen);
-        memcpy(reply_buf + content_len, content, contlen);
-        content_len += contlen;
+        // late replies of an earlier fetch or to a retransmission are dropped
+        segment = client_segment_of(p, prefix, i);
+        s = NULL;
+
+        for (k = 0; segment >= 0 && k < CCNL_CLIENT_WINDOW_MAX; k++) {
+            if (client_segs[k].seg == segment) {
+                s = client_segs + k;
+            }
+        }
+
+        if (s) {
+            if (!s->retries) { // Karn: only unambiguous samples
+                client_rtt_sample(s->sent);
+            }
+
+            if (++acked >= window) {
+                acked = 0;
+
+                if (window < CCNL_CLIENT_WINDOW_MAX) {
+                    window++;
+                }
+            }
+
+            // all but the last chunk have the same size, so every segment
+            // has a fixed place in reply_buf regardless of arrival order
+            DEBUGMSG(1, "segment=%d contlen=%d\n", segment, contlen);
+
+            if (contlen > reply_buf_size - segment * CCNL_RIOT_CHUNK_SIZE) {
+                DEBUGMSG(1, "  segment %d does not fit into reply_buf (%d bytes)\n",
+                         segment, reply_buf_size);
+                free_prefix(p);
+                ccnl_buf_free(buf);
+                ccnl_buf_free(nonce);
+                ccnl_buf_free(ppkd);
+                ccnl_free(rmsg_reply);
+                return 0;
+            }
+
+            memcpy(reply_buf + segment * CCNL_RIOT_CHUNK_SIZE, content, contlen);
+            received++;
+            s->seg = -1;
+
+            if (contlen < CCNL_RIOT_CHUNK_SIZE || CCNL_RIOT_CHUNK_SIZE < contlen) {
+                /* last chunk */
+                last_segment = segment;
+                content_len = segment * CCNL_RIOT_CHUNK_SIZE + contlen;
+
+                // interests beyond the end will never be answered
+                for (k = 0; k < CCNL_CLIENT_WINDOW_MAX; k++) {
+                    if (client_segs[k].seg > last_segment) {
+                        client_segs[k].seg = -1;
+                    }
+                }
+            }
+        }
 
         free_prefix(p);
-        free_3ptr_list(buf, nonce, ppkd);
+        ccnl_buf_free(buf);
+        ccnl_buf_free(nonce);
+        ccnl_buf_free(ppkd);
         ccnl_free(rmsg_reply);
 
-        if (contlen < CCNL_RIOT_CHUNK_SIZE || CCNL_RIOT_CHUNK_SIZE < contlen) {
-            /* last chunk */
+        if (last_segment >= 0 && received > last_segment) {
             break;
         }
     }
@@ -131,11 +364,12 @@ int ccnl_riot_client_new_face(unsigned int relay_pid, char *type, char *faceid,
     return rmsg_reply->size;
 }
 
-int ccnl_riot_client_register_prefix(unsigned int relay_pid, char *prefix, char *faceid,
-                         unsigned char *reply_buf)
+int ccnl_riot_client_register_prefix_strategy(unsigned int relay_pid,
+        char *prefix, char *faceid, char *strategy, unsigned char *reply_buf)
 {
     DEBUGMSG(1, "riot_register_prefix: mkPrefixregRequest\n");
-    int len = mkPrefixregRequest(reply_buf, 1, prefix, faceid);
+    int len = mkPrefixregRequestStrategy(reply_buf, 1, prefix, faceid,
+                                         strategy);
 
     riot_ccnl_msg_t rmsg;
     rmsg.payload = reply_buf;
@@ -158,6 +392,13 @@ int ccnl_riot_client_register_prefix(unsigned int relay_pid, char *prefix, char
     return rmsg_reply->size;
 }
 
+int ccnl_riot_client_register_prefix(unsigned int relay_pid, char *prefix, char *faceid,
+                         unsigned char *reply_buf)
+{
+    return ccnl_riot_client_register_prefix_strategy(relay_pid, prefix, faceid,
+            NULL, reply_buf);
+}
+
 int ccnl_riot_client_publish(unsigned int relay_pid, char *prefix, char *faceid, char *type, unsigned char *reply_buf)
 {
     ccnl_riot_client_new_face(relay_pid, type, faceid, reply_buf);
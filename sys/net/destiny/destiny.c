@@ -53,9 +53,7 @@ int destiny_init_transport_layer(void)
 
 #ifdef DESTINY_WITH_TCP
     /* TCP */
-    timex_t now;
-    vtimer_now(&now);
-    srand(now.microseconds);
+    srand((unsigned int) vtimer_now64());
 #ifdef TCP_HC
     printf("TCP_HC enabled!\n");
     global_context_counter = rand();
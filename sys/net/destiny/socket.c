@@ -22,6 +22,7 @@
 #include <string.h>
 
 #include "hwtimer.h"
+#include "irq.h"
 #include "ipv6.h"
 #include "thread.h"
 #include "vtimer.h"
@@ -110,14 +111,13 @@ void print_tcp_flags(tcp_hdr_t *tcp_header)
 
 void print_tcp_cb(tcp_cb_t *cb)
 {
-    timex_t now;
-    vtimer_now(&now);
+    timex64_t now = vtimer_now64();
     printf("Send_ISS: %" PRIu32 "\nSend_UNA: %" PRIu32 "\nSend_NXT: %" PRIu32 "\nSend_WND: %u\n",
            cb->send_iss, cb->send_una, cb->send_nxt, cb->send_wnd);
     printf("Rcv_IRS: %" PRIu32 "\nRcv_NXT: %" PRIu32 "\nRcv_WND: %u\n",
            cb->rcv_irs, cb->rcv_nxt, cb->rcv_wnd);
     printf("Time difference: %" PRIu32 ", No_of_retries: %u, State: %u\n\n",
-           timex_sub(now, cb->last_packet_time).microseconds, cb->no_of_retries, cb->state);
+           (uint32_t)(now - cb->last_packet_time), cb->no_of_retries, cb->state);
 }
 
 void print_tcp_status(int in_or_out, ipv6_hdr_t *ipv6_header,
@@ -591,9 +591,7 @@ int destiny_socket_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
                current_tcp_socket->tcp_control.send_iss, 0);
 
     /* Remember current time */
-    timex_t now;
-    vtimer_now(&now);
-    current_tcp_socket->tcp_control.last_packet_time = now;
+    current_tcp_socket->tcp_control.last_packet_time = vtimer_now64();
     current_tcp_socket->tcp_control.no_of_retries = 0;
 
     msg_from_server.type = TCP_RETRY;
@@ -656,8 +654,7 @@ int destiny_socket_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
     msg_from_server.type = UNDEFINED;
 
     /* Remember current time */
-    vtimer_now(&now);
-    current_tcp_socket->tcp_control.last_packet_time = now;
+    current_tcp_socket->tcp_control.last_packet_time = vtimer_now64();
     current_tcp_socket->tcp_control.no_of_retries = 0;
 
 #ifdef TCP_HC
@@ -697,9 +694,9 @@ int destiny_socket_connect(int socket, sockaddr6_t *addr, uint32_t addrlen)
     return 0;
 }
 
-void calculate_rto(tcp_cb_t *tcp_control, long current_time)
+void calculate_rto(tcp_cb_t *tcp_control, timex64_t current_time)
 {
-    double rtt = current_time - tcp_control->last_packet_time.microseconds;
+    double rtt = current_time - tcp_control->last_packet_time;
     double srtt = tcp_control->srtt;
     double rttvar = tcp_control->rttvar;
     double rto = tcp_control->rto;
@@ -827,15 +824,14 @@ int32_t destiny_socket_send(int s, const void *buf, uint32_t len, int flags)
             }
 
             /* Remember current time */
-            current_tcp_socket->tcp_control.last_packet_time.microseconds =
-                hwtimer_now();
+            current_tcp_socket->tcp_control.last_packet_time = vtimer_now64();
             net_msg_receive(&recv_msg);
 
             switch (recv_msg.type) {
                 case TCP_ACK: {
                     if (current_tcp_socket->tcp_control.no_of_retries == 0) {
                         calculate_rto(&current_tcp_socket->tcp_control,
-                                      hwtimer_now());
+                                      vtimer_now64());
                     }
 
                     tcp_hdr_t *tcp_header = ((tcp_hdr_t *)(recv_msg.content.ptr));
@@ -986,28 +982,49 @@ int32_t destiny_socket_recvfrom(int s, void *buf, uint32_t len, int flags,
     (void) flags;
 
     if (isUDPSocket(s)) {
-        msg_t m_recv, m_send;
+        socket_internal_t *current_socket = get_socket(s);
         ipv6_hdr_t *ipv6_header;
         udp_hdr_t *udp_header;
         uint8_t *payload;
-        get_socket(s)->recv_pid = thread_getpid();
+        uint32_t payload_len;
+        current_socket->recv_pid = thread_getpid();
 
-        msg_receive(&m_recv);
+        /* the UDP handler leaves the packet in the socket and wakes us,
+         * see udp_deliver(); our message queue stays untouched */
+        while (1) {
+            unsigned state = disableIRQ();
+
+            if (current_socket->recv_pending) {
+                restoreIRQ(state);
+                break;
+            }
+
+            current_socket->recv_waiting = 1;
+            thread_sleep();
+            restoreIRQ(state);
+        }
 
-        ipv6_header = ((ipv6_hdr_t *)m_recv.content.ptr);
-        udp_header = ((udp_hdr_t *)(m_recv.content.ptr + IPV6_HDR_LEN));
-        payload = (uint8_t *)(m_recv.content.ptr + IPV6_HDR_LEN + UDP_HDR_LEN);
+        ipv6_header = current_socket->recv_packet;
+        udp_header = ((udp_hdr_t *)((uint8_t *) ipv6_header + IPV6_HDR_LEN));
+        payload = (uint8_t *) ipv6_header + IPV6_HDR_LEN + UDP_HDR_LEN;
+        payload_len = NTOHS(udp_header->length) - UDP_HDR_LEN;
+
+        if (payload_len > len) {
+            payload_len = len;
+        }
 
         memset(buf, 0, len);
-        memcpy(buf, payload, NTOHS(udp_header->length) - UDP_HDR_LEN);
+        memcpy(buf, payload, payload_len);
         memcpy(&from->sin6_addr, &ipv6_header->srcaddr, 16);
         from->sin6_family = AF_INET6;
         from->sin6_flowinfo = 0;
         from->sin6_port = NTOHS(udp_header->src_port);
         *fromlen = sizeof(sockaddr6_t);
 
-        msg_reply(&m_recv, &m_send);
-        return NTOHS(udp_header->length) - UDP_HDR_LEN;
+        current_socket->recv_packet = NULL;
+        current_socket->recv_pending = 0;
+        thread_wakeup(current_socket->recv_handler_pid);
+        return payload_len;
     }
 #ifdef DESTINY_WITH_TCP
     else if (is_tcp_socket(s)) {
@@ -1263,9 +1280,7 @@ int handle_new_tcp_connection(socket_internal_t *current_queued_int_socket,
            sizeof(server_socket->socket_values.tcp_control.tcp_context.context_id));
 #endif
     /* Remember current time */
-    timex_t now;
-    vtimer_now(&now);
-    current_queued_int_socket->socket_values.tcp_control.last_packet_time = now;
+    current_queued_int_socket->socket_values.tcp_control.last_packet_time = vtimer_now64();
 
     current_queued_int_socket->socket_values.tcp_control.no_of_retries = 0;
 
@@ -1410,3 +1425,94 @@ socket_internal_t *new_tcp_queued_socket(ipv6_hdr_t *ipv6_header,
     return current_queued_socket;
 }
 #endif
+
+#ifdef MODULE_POSIX
+static int socket_fd_read(int s, char *buffer, int bufsize)
+{
+    sockaddr6_t from;
+    uint32_t fromlen;
+
+    return destiny_socket_recvfrom(s, buffer, bufsize, 0, &from, &fromlen);
+}
+
+static int socket_fd_write(int s, const char *buffer, int bufsize)
+{
+#ifdef DESTINY_WITH_TCP
+    if (is_tcp_socket(s)) {
+        return destiny_socket_send(s, buffer, bufsize, 0);
+    }
+#endif
+
+    /* datagrams need a destination, use destiny_socket_sendto() */
+    (void) s;
+    (void) buffer;
+    (void) bufsize;
+    return -1;
+}
+
+static int socket_fd_close(int s)
+{
+    return destiny_socket_close(s);
+}
+
+static int socket_fd_poll(int s)
+{
+    socket_internal_t *current_socket;
+
+    if ((s < 1) || (s > MAX_SOCKETS) || !exists_socket(s)) {
+        return POLLHUP;
+    }
+
+    current_socket = get_socket(s);
+
+    if (isUDPSocket(s)) {
+        return current_socket->recv_pending ? (POLLIN | POLLOUT) : POLLOUT;
+    }
+
+#ifdef DESTINY_WITH_TCP
+    if (is_tcp_socket(s)) {
+        int events = 0;
+
+        if (current_socket->tcp_input_buffer_end > 0) {
+            events |= POLLIN;
+        }
+
+        switch (current_socket->socket_values.tcp_control.state) {
+            case ESTABLISHED:
+                events |= POLLOUT;
+                break;
+
+            case CLOSE_WAIT:
+            case CLOSING:
+            case LAST_ACK:
+            case TIME_WAIT:
+                events |= POLLHUP;
+                break;
+
+            default:
+                break;
+        }
+
+        return events;
+    }
+#endif
+
+    return POLLERR;
+}
+
+const fd_ops_t destiny_socket_fd_ops = {
+    socket_fd_read,
+    socket_fd_write,
+    socket_fd_close,
+    socket_fd_poll
+};
+
+int destiny_socket_fd_open(int s)
+{
+    if ((s < 1) || (s > MAX_SOCKETS) || !exists_socket(s)) {
+        return -1;
+    }
+
+    return fd_new(&destiny_socket_fd_ops, s);
+}
+#endif
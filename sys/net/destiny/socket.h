@@ -35,7 +35,7 @@ typedef struct __attribute__((packed)) {
     uint16_t			rcv_wnd;
     uint32_t			rcv_irs;
 
-    timex_t				last_packet_time;
+    timex64_t			last_packet_time;
     uint8_t				no_of_retries;
     uint16_t			mss;
 
@@ -64,6 +64,10 @@ typedef struct __attribute__((packed)) {
     uint8_t				recv_pid;
     uint8_t				send_pid;
     uint8_t				tcp_input_buffer_end;
+    uint8_t				recv_pending;   // UDP packet waiting in recv_packet
+    uint8_t				recv_waiting;   // recv_pid sleeps in recvfrom
+    uint8_t				recv_handler_pid;   // UDP handler waiting for the packet to be taken
+    ipv6_hdr_t			*recv_packet;
     mutex_t				tcp_buffer_mutex;
     socket_t			socket_values;
     uint8_t				tcp_input_buffer[DESTINY_SOCKET_MAX_TCP_BUFFER];
@@ -92,4 +96,10 @@ int send_tcp(socket_internal_t *current_socket, tcp_hdr_t *current_tcp_packet,
              uint8_t payload_length);
 bool is_tcp_socket(int s);
 
+#ifdef MODULE_POSIX
+#include "fd.h"
+
+extern const fd_ops_t destiny_socket_fd_ops;
+#endif
+
 #endif /* _DESTINY_SOCKET */
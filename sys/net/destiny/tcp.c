@@ -103,6 +103,10 @@ uint8_t handle_payload(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
         mutex_unlock(&tcp_socket->tcp_buffer_mutex);
     }
 
+#ifdef MODULE_POSIX
+    fd_notify(&destiny_socket_fd_ops, tcp_socket->socket_id);
+#endif
+
     if (thread_getstatus(tcp_socket->recv_pid) == STATUS_RECEIVE_BLOCKED) {
         net_msg_send_recv(&m_send_tcp, &m_recv_tcp, tcp_socket->recv_pid, UNDEFINED);
     }
@@ -229,6 +233,9 @@ void handle_tcp_fin_packet(ipv6_hdr_t *ipv6_header, tcp_hdr_t *tcp_header,
         send_tcp(tcp_socket, current_tcp_packet, temp_ipv6_header, TCP_FIN_ACK, 0);
     }
 
+#ifdef MODULE_POSIX
+    fd_notify(&destiny_socket_fd_ops, tcp_socket->socket_id);
+#endif
     net_msg_send(&m_send, tcp_socket->recv_pid, 0, CLOSE_CONN);
 }
 
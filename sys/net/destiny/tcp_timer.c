@@ -39,19 +39,16 @@ void handle_synchro_timeout(socket_internal_t *current_socket)
     msg_t send;
 
     if (thread_getstatus(current_socket->recv_pid) == STATUS_RECEIVE_BLOCKED) {
-        timex_t now;
-        vtimer_now(&now);
+        timex64_t elapsed = vtimer_now64() -
+                            current_socket->socket_values.tcp_control.last_packet_time;
 
         if ((current_socket->socket_values.tcp_control.no_of_retries == 0) &&
-            (timex_sub(now,
-                       current_socket->socket_values.tcp_control.last_packet_time).microseconds >
-             TCP_SYN_INITIAL_TIMEOUT)) {
+            (elapsed > TCP_SYN_INITIAL_TIMEOUT)) {
             current_socket->socket_values.tcp_control.no_of_retries++;
             net_msg_send(&send, current_socket->recv_pid, 0, TCP_RETRY);
         }
         else if ((current_socket->socket_values.tcp_control.no_of_retries > 0) &&
-                 (timex_sub(now,
-                            current_socket->socket_values.tcp_control.last_packet_time).microseconds >
+                 (elapsed >
                   (current_socket->socket_values.tcp_control.no_of_retries *
                    TCP_SYN_TIMEOUT + TCP_SYN_INITIAL_TIMEOUT))) {
             current_socket->socket_values.tcp_control.no_of_retries++;
@@ -86,14 +83,13 @@ void handle_established(socket_internal_t *current_socket)
             current_timeout *= 2;
         }
 
-        timex_t now;
-        vtimer_now(&now);
+        timex64_t elapsed = vtimer_now64() -
+                            current_socket->socket_values.tcp_control.last_packet_time;
 
         if (current_timeout > TCP_ACK_MAX_TIMEOUT) {
             net_msg_send(&send, current_socket->send_pid, 0, TCP_TIMEOUT);
         }
-        else if (timex_sub(now, current_socket->socket_values.tcp_control.last_packet_time).microseconds >
-                 current_timeout) {
+        else if (elapsed > current_timeout) {
             current_socket->socket_values.tcp_control.no_of_retries++;
             net_msg_send(&send, current_socket->send_pid, 0, TCP_RETRY);
         }
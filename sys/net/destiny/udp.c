@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "ipv6.h"
+#include "irq.h"
 #include "msg.h"
 #include "sixlowpan.h"
 #include "thread.h"
@@ -43,9 +44,52 @@ uint16_t udp_csum(ipv6_hdr_t *ipv6_header, udp_hdr_t *udp_header)
     return (sum == 0) ? 0xffff : HTONS(sum);
 }
 
+/*
+ * Hands the packet to the socket and waits until destiny_socket_recvfrom()
+ * has copied it, the packet belongs to the IP layer until we reply there.
+ * No message goes to the receiver, so it can wait for other messages on
+ * its queue at the same time, e.g. in fd_poll().
+ */
+static void udp_deliver(socket_internal_t *udp_socket, ipv6_hdr_t *ipv6_header)
+{
+    int wake = 0;
+    unsigned state = disableIRQ();
+
+    udp_socket->recv_packet = ipv6_header;
+    udp_socket->recv_handler_pid = thread_getpid();
+    udp_socket->recv_pending = 1;
+
+    if (udp_socket->recv_waiting) {
+        udp_socket->recv_waiting = 0;
+        wake = 1;
+    }
+
+    restoreIRQ(state);
+
+    if (wake) {
+        thread_wakeup(udp_socket->recv_pid);
+    }
+
+#ifdef MODULE_POSIX
+    fd_notify(&destiny_socket_fd_ops, udp_socket->socket_id);
+#endif
+
+    while (1) {
+        state = disableIRQ();
+
+        if (!udp_socket->recv_pending) {
+            restoreIRQ(state);
+            break;
+        }
+
+        thread_sleep();
+        restoreIRQ(state);
+    }
+}
+
 void udp_packet_handler(void)
 {
-    msg_t m_recv_ip, m_send_ip, m_recv_udp, m_send_udp;
+    msg_t m_recv_ip, m_send_ip;
     ipv6_hdr_t *ipv6_header;
     udp_hdr_t *udp_header;
     socket_internal_t *udp_socket = NULL;
@@ -62,8 +106,7 @@ void udp_packet_handler(void)
             udp_socket = get_udp_socket(udp_header);
 
             if (udp_socket != NULL) {
-                m_send_udp.content.ptr = (char *)ipv6_header;
-                msg_send_receive(&m_send_udp, &m_recv_udp, udp_socket->recv_pid);
+                udp_deliver(udp_socket, ipv6_header);
             }
             else {
                 printf("Dropped UDP Message because no thread ID was found for delivery!\n");
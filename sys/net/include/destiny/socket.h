@@ -323,6 +323,19 @@ int destiny_socket_accept(int s, sockaddr6_t *addr, socklen_t *addrlen);
  */
 void destiny_socket_print_sockets(void);
 
+/**
+ * Opens socket *s* as file descriptor, so it can be waited for with
+ * fd_poll() together with other sources, see fd.h. Reading receives
+ * like destiny_socket_recvfrom() without the source address, writing
+ * works on connected TCP sockets only, closing closes the socket.
+ * Needs module posix.
+ *
+ * @param[in] s The socket.
+ *
+ * @return The file descriptor, -1 on error.
+ */
+int destiny_socket_fd_open(int s);
+
 /**
  * @}
  */
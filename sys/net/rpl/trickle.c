@@ -63,10 +63,8 @@ void reset_trickletimer(void)
     c = 0;
     /* start timer */
     t = (I / 2) + (rand() % (I - (I / 2) + 1));
-    t_time = timex_set(0, t * 1000);
-    I_time = timex_set(0, I * 1000);
-    timex_normalize(&t_time);
-    timex_normalize(&I_time);
+    t_time = timex_from_64((timex64_t) t * 1000);
+    I_time = timex_from_64((timex64_t) I * 1000);
     vtimer_remove(&trickle_t_timer);
     vtimer_remove(&trickle_I_timer);
     vtimer_set_wakeup(&trickle_t_timer, t_time, timer_over_pid);
@@ -106,10 +104,8 @@ void start_trickle(uint8_t DIOIntMin, uint8_t DIOIntDoubl,
     I = Imin + (rand() % (4 * Imin)) ;
 
     t = (I / 2) + (rand() % (I - (I / 2) + 1));
-    t_time = timex_set(0, t * 1000);
-    timex_normalize(&t_time);
-    I_time = timex_set(0, I * 1000);
-    timex_normalize(&I_time);
+    t_time = timex_from_64((timex64_t) t * 1000);
+    I_time = timex_from_64((timex64_t) I * 1000);
     vtimer_remove(&trickle_t_timer);
     vtimer_remove(&trickle_I_timer);
     vtimer_set_wakeup(&trickle_t_timer, t_time, timer_over_pid);
@@ -161,10 +157,8 @@ void trickle_interval_over(void)
         c = 0;
         t = (I / 2) + (rand() % (I - (I / 2) + 1));
         /* start timer */
-        t_time = timex_set(0, t * 1000);
-        timex_normalize(&t_time);
-        I_time = timex_set(0, I * 1000);
-        timex_normalize(&I_time);
+        t_time = timex_from_64((timex64_t) t * 1000);
+        I_time = timex_from_64((timex64_t) I * 1000);
 
         vtimer_remove(&trickle_t_timer);
         if (vtimer_set_wakeup(&trickle_t_timer, t_time, timer_over_pid) != 0) {
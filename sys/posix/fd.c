@@ -0,0 +1,240 @@
+/**
+ * File descriptor table and poll()
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup posix
+ * @{
+ * @file    fd.c
+ * @author  Freie Universität Berlin, Computer Systems & Telematics
+ * @}
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "cib.h"
+#include "irq.h"
+#include "msg.h"
+#include "sched.h"
+#include "tcb.h"
+#include "thread.h"
+#include "vtimer.h"
+
+#include "fd.h"
+
+static fd_t fd_table[FD_MAX];
+
+int fd_new(const fd_ops_t *ops, int internal)
+{
+    unsigned state = disableIRQ();
+
+    for (int i = 0; i < FD_MAX; i++) {
+        if (fd_table[i].ops == NULL) {
+            fd_table[i].ops = ops;
+            fd_table[i].internal = internal;
+            fd_table[i].waiter = -1;
+            restoreIRQ(state);
+            return i;
+        }
+    }
+
+    restoreIRQ(state);
+    return -1;
+}
+
+fd_t *fd_get(int fd)
+{
+    if ((fd < 0) || (fd >= FD_MAX) || (fd_table[fd].ops == NULL)) {
+        return NULL;
+    }
+
+    return &fd_table[fd];
+}
+
+void fd_destroy(int fd)
+{
+    fd_t *f = fd_get(fd);
+
+    if (f != NULL) {
+        f->ops = NULL;
+    }
+}
+
+int fd_read(int fd, char *buffer, int bufsize)
+{
+    fd_t *f = fd_get(fd);
+
+    if ((f == NULL) || (f->ops->read == NULL)) {
+        return -1;
+    }
+
+    return f->ops->read(f->internal, buffer, bufsize);
+}
+
+int fd_write(int fd, const char *buffer, int bufsize)
+{
+    fd_t *f = fd_get(fd);
+
+    if ((f == NULL) || (f->ops->write == NULL)) {
+        return -1;
+    }
+
+    return f->ops->write(f->internal, buffer, bufsize);
+}
+
+int fd_close(int fd)
+{
+    fd_t *f = fd_get(fd);
+    int res = 0;
+
+    if (f == NULL) {
+        return -1;
+    }
+
+    if (f->ops->close != NULL) {
+        res = f->ops->close(f->internal);
+    }
+
+    fd_destroy(fd);
+    return res;
+}
+
+void fd_notify(const fd_ops_t *ops, int internal)
+{
+    for (int i = 0; i < FD_MAX; i++) {
+        if ((fd_table[i].ops == ops) && (fd_table[i].internal == internal) &&
+            (fd_table[i].waiter != -1)) {
+            thread_wakeup(fd_table[i].waiter);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* senders to a polling thread wake it themselves, see thread_poll_sleep() */
+static int msg_poll(int pid)
+{
+    tcb_t *t = (tcb_t *) sched_threads[pid];
+
+    if (t == NULL) {
+        return POLLERR;
+    }
+
+    if ((t->msg_array && (cib_avail(&t->msg_queue) > 0)) ||
+        (t->msg_waiters.next != NULL)) {
+        return POLLIN;
+    }
+
+    return 0;
+}
+
+static int msg_read(int pid, char *buffer, int bufsize)
+{
+    msg_t m;
+
+    if ((pid != thread_getpid()) || (bufsize < (int) sizeof(msg_t))) {
+        return -1;
+    }
+
+    msg_receive(&m);
+    memcpy(buffer, &m, sizeof(msg_t));
+    return sizeof(msg_t);
+}
+
+const fd_ops_t fd_msg_ops = {
+    msg_read,
+    NULL,
+    NULL,
+    msg_poll
+};
+
+int fd_msg_open(void)
+{
+    return fd_new(&fd_msg_ops, thread_getpid());
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* called with interrupts disabled, so no source can become ready unnoticed
+ * between the check and the poller going to sleep */
+static int poll_check(struct fd_pollfd *fds, unsigned int nfds, int waiter)
+{
+    int n = 0;
+
+    for (unsigned int i = 0; i < nfds; i++) {
+        fd_t *f;
+
+        fds[i].revents = 0;
+
+        if (fds[i].fd < 0) {
+            continue;
+        }
+
+        f = fd_get(fds[i].fd);
+
+        if (f == NULL) {
+            fds[i].revents = POLLNVAL;
+        }
+        else {
+            f->waiter = waiter;
+
+            if (f->ops->poll != NULL) {
+                fds[i].revents = f->ops->poll(f->internal) &
+                                 (fds[i].events | POLLERR | POLLHUP);
+            }
+        }
+
+        if (fds[i].revents) {
+            n++;
+        }
+    }
+
+    return n;
+}
+
+int fd_poll(struct fd_pollfd *fds, unsigned int nfds, int timeout)
+{
+    int me = thread_getpid();
+    timex64_t deadline = 0;
+    vtimer_t timer;
+    int n;
+
+    if (timeout > 0) {
+        deadline = vtimer_now64() + (timex64_t) timeout * 1000;
+        vtimer_set_wakeup(&timer, timex_from_64((timex64_t) timeout * 1000), me);
+    }
+
+    while (1) {
+        unsigned state = disableIRQ();
+
+        n = poll_check(fds, nfds, me);
+
+        if (n || (timeout == 0) ||
+            ((timeout > 0) && (timex64_delta(vtimer_now64(), deadline) >= 0))) {
+            restoreIRQ(state);
+            break;
+        }
+
+        thread_poll_sleep();
+        restoreIRQ(state);
+    }
+
+    if (timeout > 0) {
+        vtimer_remove(&timer);
+    }
+
+    for (unsigned int i = 0; i < nfds; i++) {
+        fd_t *f = fd_get(fds[i].fd);
+
+        if ((f != NULL) && (f->waiter == me)) {
+            f->waiter = -1;
+        }
+    }
+
+    return n;
+}
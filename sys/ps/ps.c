@@ -30,7 +30,9 @@ const char *state_names[] = {
     "bl mutex",
     "bl rx",
     "bl send",
-    "bl reply"
+    "bl reply",
+    "bl timer",
+    "bl poll"
 };
 
 /**
@@ -0,0 +1,42 @@
+/**
+ * PCG32 pseudo random number generator
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * pcg32 (XSH RR) as described by Melissa O'Neill, see
+ * http://www.pcg-random.org/
+ *
+ * @file
+ * @author Freie Universität Berlin, Computer Systems & Telematics
+ */
+
+#include "random.h"
+#include "prng_bounded.h"
+
+void pcg32_init(pcg32_t *g, uint64_t seed, uint64_t seq)
+{
+    g->state = 0;
+    g->inc = (seq << 1) | 1;
+    pcg32_next(g);
+    g->state += seed;
+    pcg32_next(g);
+}
+
+uint32_t pcg32_next(pcg32_t *g)
+{
+    uint64_t old = g->state;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+
+    g->state = old * 6364136223846793005ULL + g->inc;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+uint32_t pcg32_bounded(pcg32_t *g, uint32_t n)
+{
+    PRNG_BOUNDED(pcg32_next(g), n);
+}
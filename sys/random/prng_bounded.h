@@ -0,0 +1,40 @@
+/**
+ * Unbiased bounded random numbers, shared by the generators
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * Lemire, "Fast Random Integer Generation in an Interval": the high word
+ * of next * n is uniform on [0,n) unless the low word falls below
+ * 2^32 mod n, in which case the draw is repeated. The modulo is only
+ * computed when the low word is below n, i.e. rarely for small n.
+ *
+ * @file
+ * @author Freie Universität Berlin, Computer Systems & Telematics
+ */
+
+#ifndef __PRNG_BOUNDED_H
+#define __PRNG_BOUNDED_H
+
+/* returns from the enclosing function, 'next' is evaluated once per draw */
+#define PRNG_BOUNDED(next, n) \
+    do { \
+        uint64_t m = (uint64_t)(next) * (n); \
+        uint32_t l = (uint32_t) m; \
+        \
+        if (l < (n)) { \
+            uint32_t t = -(n) % (n); \
+            \
+            while (l < t) { \
+                m = (uint64_t)(next) * (n); \
+                l = (uint32_t) m; \
+            } \
+        } \
+        \
+        return (uint32_t)(m >> 32); \
+    } while (0)
+
+#endif /* __PRNG_BOUNDED_H */
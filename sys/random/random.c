@@ -0,0 +1,102 @@
+/**
+ * Default pseudo random number generator
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @file
+ * @author Freie Universität Berlin, Computer Systems & Telematics
+ */
+
+#if defined(__linux__) || defined(__MACH__) || defined(__FreeBSD__)
+#  define HAVE_URANDOM
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include "hwtimer.h"
+#include "random.h"
+#include "prng_bounded.h"
+
+#if PRNG_BACKEND == PRNG_XOSHIRO
+static xoshiro128_t prng;
+#  define PRNG_INIT(s)  xoshiro128_init(&prng, (s))
+#  define PRNG_NEXT()   xoshiro128_next(&prng)
+#elif PRNG_BACKEND == PRNG_PCG32
+static pcg32_t prng;
+#  define PRNG_INIT(s)  pcg32_init(&prng, (s), 0)
+#  define PRNG_NEXT()   pcg32_next(&prng)
+#elif PRNG_BACKEND == PRNG_MERSENNE
+#  define PRNG_INIT(s)  genrand_init(s)
+#  define PRNG_NEXT()   genrand_uint32()
+#else
+#  error "unknown PRNG_BACKEND"
+#endif
+
+void random_init(uint32_t s)
+{
+    PRNG_INIT(s);
+}
+
+/*
+ * Without a hardware source the seed comes from the timer: the number of
+ * ticks at this point of the boot and how far apart a few reads land.
+ * That tells devices apart which boot at different times, no more;
+ * callers with a better source should use random_init() instead.
+ */
+static uint32_t timer_seed(void)
+{
+    uint32_t s = 0;
+
+    for (int i = 0; i < 8; i++) {
+        s = (s << 5 | s >> 27) ^ (uint32_t) hwtimer_now();
+        s *= 0x9e3779b1;
+    }
+
+    return s;
+}
+
+uint32_t random_init_entropy(void)
+{
+    uint32_t s = 0;
+
+#ifdef HAVE_URANDOM
+    int fd = open("/dev/urandom", O_RDONLY);
+
+    if (fd < 0 || read(fd, &s, sizeof(s)) != sizeof(s)) {
+        s = timer_seed();
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+#else
+    s = timer_seed();
+#endif
+
+    random_init(s);
+    return s;
+}
+
+uint32_t random_uint32(void)
+{
+    return PRNG_NEXT();
+}
+
+uint32_t random_bounded(uint32_t n)
+{
+    PRNG_BOUNDED(PRNG_NEXT(), n);
+}
+
+uint32_t random_range(uint32_t lo, uint32_t hi)
+{
+    return lo + random_bounded(hi - lo);
+}
+
+uint16_t random_q16(void)
+{
+    return (uint16_t)(PRNG_NEXT() >> 16);
+}
@@ -0,0 +1,60 @@
+/**
+ * xoshiro128** pseudo random number generator
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * The generator is by David Blackman and Sebastiano Vigna, who placed it
+ * in the public domain, see http://xoshiro.di.unimi.it/
+ *
+ * @file
+ * @author Freie Universität Berlin, Computer Systems & Telematics
+ */
+
+#include "random.h"
+#include "prng_bounded.h"
+
+static inline uint32_t rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/* the state must not be all zero, splitmix64 spreads the seed over it */
+void xoshiro128_init(xoshiro128_t *g, uint32_t seed)
+{
+    uint64_t x = seed;
+
+    for (int i = 0; i < 4; i += 2) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        g->s[i] = (uint32_t) z;
+        g->s[i + 1] = (uint32_t)(z >> 32);
+    }
+}
+
+uint32_t xoshiro128_next(xoshiro128_t *g)
+{
+    uint32_t *s = g->s;
+    uint32_t result = rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+
+    return result;
+}
+
+uint32_t xoshiro128_bounded(xoshiro128_t *g, uint32_t n)
+{
+    PRNG_BOUNDED(xoshiro128_next(g), n);
+}
@@ -0,0 +1,55 @@
+/**
+ * Shell commands for binlog
+ *
+ * Copyright (C) 2013 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License. See the file LICENSE in the top level directory for more
+ * details.
+ *
+ * @ingroup shell_commands
+ * @{
+ * @file    sc_binlog.c
+ * @brief   shows and sets binlog levels and output mode
+ * @author  Freie Universität Berlin, Computer Systems & Telematics
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "binlog.h"
+
+void _binlog_handler(char *str)
+{
+    char *saveptr;
+    char *arg;
+
+    strtok_r(str, " ", &saveptr);
+    arg = strtok_r(NULL, " ", &saveptr);
+
+    if (arg == NULL) {
+        for (unsigned int i = 0; i < BINLOG_MODULES; i++) {
+            printf("module %u: level %u\n", i, binlog_level[i]);
+        }
+
+        printf("%lu records dropped\n", (unsigned long) binlog_dropped());
+    }
+    else if (strcmp(arg, "binary") == 0) {
+        binlog_set_binary(1);
+    }
+    else if (strcmp(arg, "text") == 0) {
+        binlog_set_binary(0);
+    }
+    else {
+        char *level = strtok_r(NULL, " ", &saveptr);
+
+        if (level == NULL) {
+            puts("usage: binlog [<module> <level> | binary | text]");
+            return;
+        }
+
+        binlog_set_level(atoi(arg), atoi(level));
+    }
+}
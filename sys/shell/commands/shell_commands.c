@@ -33,6 +33,10 @@ extern void _ps_handler(char *unused);
 extern void _date_handler(char *now);
 #endif
 
+#ifdef MODULE_BINLOG
+extern void _binlog_handler(char *str);
+#endif
+
 #ifdef MODULE_SHT11
 extern void _get_temperature_handler(char *unused);
 extern void _get_humidity_handler(char *unused);
@@ -103,6 +107,9 @@ const shell_command_t _shell_command_list[] = {
 #ifdef MODULE_RTC
     {"date", "Gets or sets current date and time.", _date_handler},
 #endif
+#ifdef MODULE_BINLOG
+    {"binlog", "Shows or sets binlog module levels and output mode.", _binlog_handler},
+#endif
 #ifdef MODULE_SHT11
     {"temp", "Prints measured temperature.", _get_temperature_handler},
     {"hum", "Prints measured humidity.", _get_humidity_handler},
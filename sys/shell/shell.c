@@ -33,7 +33,18 @@
 #include <stdint.h>
 #include <stdlib.h>
 
-static void(*find_handler(const shell_command_t *command_list, char *command))(char *)
+#include "hwtimer.h"
+#ifdef MODULE_VTIMER
+#include "vtimer.h"
+#endif
+
+/* command is the first len characters of a line, it is not terminated */
+static int name_is(const char *name, const char *command, size_t len)
+{
+    return (strncmp(name, command, len) == 0) && (name[len] == '\0');
+}
+
+static void(*find_handler(const shell_command_t *command_list, const char *command, size_t len))(char *)
 {
     const shell_command_t *command_lists[] = {
         command_list,
@@ -49,7 +60,7 @@ static void(*find_handler(const shell_command_t *command_list, char *command))(c
         if ((entry = command_lists[i])) {
             /* iterating over commands in command_lists entry */
             while (entry->name != NULL) {
-                if (strcmp(entry->name, command) == 0) {
+                if (name_is(entry->name, command, len)) {
                     return entry->handler;
                 }
                 else {
@@ -62,6 +73,91 @@ static void(*find_handler(const shell_command_t *command_list, char *command))(c
     return NULL;
 }
 
+#ifdef SHELL_INDEX_SIZE
+static unsigned int shell_hash(const char *name, size_t len)
+{
+    unsigned int h = 5381;
+
+    while (len--) {
+        h = h * 33 + (unsigned char) *name++;
+    }
+
+    return h;
+}
+
+/* open addressing over shell->index, the first command of a name wins like
+ * in find_handler() */
+static void index_commands(shell_t *shell)
+{
+    const shell_command_t *command_lists[] = {
+        shell->command_list,
+#ifdef MODULE_SHELL_COMMANDS
+        _shell_command_list,
+#endif
+    };
+
+    const shell_command_t *entry;
+
+    memset(shell->index, 0, sizeof(shell->index));
+    shell->index_complete = 1;
+
+    for (unsigned int i = 0; i < sizeof(command_lists)/sizeof(entry); i++) {
+        if (!(entry = command_lists[i])) {
+            continue;
+        }
+
+        for (; entry->name != NULL; entry++) {
+            unsigned int slot = shell_hash(entry->name, strlen(entry->name));
+            unsigned int n;
+
+            for (n = 0; n < SHELL_INDEX_SIZE; n++, slot++) {
+                const shell_command_t **s = &shell->index[slot % SHELL_INDEX_SIZE];
+
+                if (*s == NULL) {
+                    *s = entry;
+                    break;
+                }
+
+                if (strcmp((*s)->name, entry->name) == 0) {
+                    break;
+                }
+            }
+
+            if (n == SHELL_INDEX_SIZE) {
+                /* the rest is found by find_handler() */
+                shell->index_complete = 0;
+            }
+        }
+    }
+}
+
+static void(*lookup_handler(shell_t *shell, const char *command, size_t len))(char *)
+{
+    unsigned int slot = shell_hash(command, len);
+
+    for (unsigned int n = 0; n < SHELL_INDEX_SIZE; n++, slot++) {
+        const shell_command_t *entry = shell->index[slot % SHELL_INDEX_SIZE];
+
+        if (entry == NULL) {
+            break;
+        }
+
+        if (name_is(entry->name, command, len)) {
+            return entry->handler;
+        }
+    }
+
+    if (!shell->index_complete) {
+        return find_handler(shell->command_list, command, len);
+    }
+
+    return NULL;
+}
+#else
+#define lookup_handler(shell, command, len) \
+    find_handler((shell)->command_list, (command), (len))
+#endif /* SHELL_INDEX_SIZE */
+
 static void print_help(const shell_command_t *command_list)
 {
     printf("%-20s %s\n", "Command", "Description");
@@ -86,27 +182,83 @@ static void print_help(const shell_command_t *command_list)
             }
         }
     }
+
+    printf("%-20s %s\n", "repeat <n> <cmd>", "Run a command n times");
+    printf("%-20s %s\n", "time <cmd>", "Run a command and print how long it took");
 }
 
-static void handle_input_line(shell_t *shell, char *line)
+static void handle_command(shell_t *shell, const char *line, char *scratch);
+
+static void time_command(shell_t *shell, const char *cmd, char *scratch)
 {
-    char line_copy[SHELL_BUFFER_SIZE];
-    char *saveptr;
-    strncpy(line_copy, line, sizeof(line_copy));
-    char *command = strtok_r(line_copy, " ", &saveptr);
+#ifdef MODULE_VTIMER
+    timex64_t start_us = vtimer_now64();
+#endif
+    unsigned long start = hwtimer_now();
+    unsigned long ticks;
+    unsigned long us;
+
+    handle_command(shell, cmd, scratch);
+
+    ticks = hwtimer_now() - start;
+#ifdef MODULE_VTIMER
+    us = (unsigned long)(vtimer_now64() - start_us);
+#else
+    us = HWTIMER_TICKS_TO_US(ticks);
+#endif
+
+    printf("time: %lu us, %lu ticks\n", us, ticks);
+}
+
+/* returns the part of line after its first n words */
+static const char *skip_words(const char *line, int n)
+{
+    while (n--) {
+        line += strspn(line, " ");
+        line += strcspn(line, " ");
+    }
+
+    return line + strspn(line, " ");
+}
+
+/* Builtins are parsed in place, line itself is never modified. Handlers
+ * are free to modify theirs, so each call gets a fresh copy of its command
+ * in scratch (SHELL_BUFFER_SIZE bytes) and repeat can run it again. */
+static void handle_command(shell_t *shell, const char *line, char *scratch)
+{
+    const char *command = line + strspn(line, " ");
+    size_t len = strcspn(command, " ");
 
     void (*handler)(char *) = NULL;
 
-    if (command) {
-        handler = find_handler(shell->command_list, command);
+    if ((len > 0) && (command[0] != '#')) {
+        handler = lookup_handler(shell, command, len);
 
         if (handler != NULL) {
-            handler(line);
+            strncpy(scratch, line, SHELL_BUFFER_SIZE);
+            scratch[SHELL_BUFFER_SIZE - 1] = '\0';
+            handler(scratch);
         }
         else {
-            if (strcmp("help", command) == 0) {
+            if (name_is("help", command, len)) {
                 print_help(shell->command_list);
             }
+            else if (name_is("time", command, len)) {
+                time_command(shell, skip_words(command, 1), scratch);
+            }
+            else if (name_is("repeat", command, len)) {
+                const char *count = skip_words(command, 1);
+                const char *cmd = skip_words(command, 2);
+
+                if ((*count == '\0') || (*cmd == '\0')) {
+                    puts("usage: repeat <n> <command>");
+                    return;
+                }
+
+                for (long n = strtol(count, NULL, 0); n > 0; n--) {
+                    handle_command(shell, cmd, scratch);
+                }
+            }
             else {
                 puts("shell: command not found.");
             }
@@ -114,6 +266,24 @@ static void handle_input_line(shell_t *shell, char *line)
     }
 }
 
+static void handle_input_line(shell_t *shell, char *line)
+{
+    char scratch[SHELL_BUFFER_SIZE];
+    char *next;
+
+    /* "cmd1; cmd2" runs both, a builtin applies to its own command only */
+    do {
+        next = strchr(line, ';');
+
+        if (next != NULL) {
+            *next++ = '\0';
+        }
+
+        handle_command(shell, line + strspn(line, " "), scratch);
+        line = next;
+    } while (line != NULL);
+}
+
 static int readline(shell_t *shell, char *buf, size_t size)
 {
     char *line_buf_ptr = buf;
@@ -167,11 +337,51 @@ void shell_run(shell_t *shell)
     }
 }
 
+void shell_run_script(shell_t *shell, const char *script)
+{
+    char line_buf[SHELL_BUFFER_SIZE];
+
+    while (*script) {
+        size_t len = strcspn(script, "\n");
+
+        if (len < sizeof(line_buf)) {
+            memcpy(line_buf, script, len);
+            line_buf[len] = '\0';
+
+            if ((len > 0) && (line_buf[len - 1] == '\r')) {
+                line_buf[len - 1] = '\0';
+            }
+
+            /* echo like shell_run() does */
+            print_prompt(shell);
+
+            for (char *c = line_buf; *c; c++) {
+                shell->put_char(*c);
+            }
+
+            shell->put_char('\n');
+            handle_input_line(shell, line_buf);
+        }
+        else {
+            puts("shell: line too long.");
+        }
+
+        script += len;
+
+        if (*script == '\n') {
+            script++;
+        }
+    }
+}
+
 void shell_init(shell_t *shell, const shell_command_t *shell_commands, int(*readchar)(void), void(*put_char)(int))
 {
     shell->command_list = shell_commands;
     shell->readchar = readchar;
     shell->put_char = put_char;
+#ifdef SHELL_INDEX_SIZE
+    index_commands(shell);
+#endif
 }
 
 /** @} */
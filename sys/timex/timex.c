@@ -64,6 +64,20 @@ int timex_cmp(const timex_t a, const timex_t b)
     return 1;
 }
 
+timex64_t timex_to_64(const timex_t t)
+{
+    return (timex64_t) t.seconds * TIMEX64_SECOND + t.microseconds;
+}
+
+timex_t timex_from_64(timex64_t us)
+{
+    timex_t result;
+    result.seconds = (uint32_t)(us / TIMEX64_SECOND);
+    result.microseconds = (uint32_t)(us - (timex64_t) result.seconds * TIMEX64_SECOND);
+
+    return result;
+}
+
 void timex_print(const timex_t t)
 {
     printf("Seconds: %"PRIu32" - Microseconds: %"PRIu32"\n", t.seconds, t.microseconds);
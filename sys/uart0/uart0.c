@@ -1,24 +1,63 @@
 #include <stdio.h>
 
 #include "chardev_thread.h"
-#include "ringbuffer.h"
+#include "tsrb.h"
 #include "thread.h"
 #include "msg.h"
 #include "posix_io.h"
 #include "irq.h"
+#ifdef MODULE_POSIX
+#include "fd.h"
+#endif
 
 #include "board_uart0.h"
 
 #define UART0_BUFSIZE 		(32)
 #define UART0_STACKSIZE 	(MINIMUM_STACK_SIZE + 256)
 
-ringbuffer_t uart0_ringbuffer;
+tsrb_t uart0_ringbuffer;
 int uart0_handler_pid;
 
 static char buffer[UART0_BUFSIZE];
 
 static char uart0_thread_stack[UART0_STACKSIZE];
 
+#ifdef MODULE_POSIX
+static int uart0_fd_read(int pid, char *buffer, int bufsize)
+{
+    return posix_read(pid, buffer, bufsize);
+}
+
+static int uart0_fd_write(int pid, const char *buffer, int bufsize)
+{
+    (void) pid;
+
+    for (int i = 0; i < bufsize; i++) {
+        uart0_putc(buffer[i]);
+    }
+
+    return bufsize;
+}
+
+static int uart0_fd_close(int pid)
+{
+    return posix_close(pid);
+}
+
+static int uart0_fd_poll(int pid)
+{
+    (void) pid;
+    return tsrb_avail(&uart0_ringbuffer) ? (POLLIN | POLLOUT) : POLLOUT;
+}
+
+static const fd_ops_t uart0_fd_ops = {
+    uart0_fd_read,
+    uart0_fd_write,
+    uart0_fd_close,
+    uart0_fd_poll
+};
+#endif
+
 static void uart0_loop(void)
 {
     chardev_loop(&uart0_ringbuffer);
@@ -26,7 +65,7 @@ static void uart0_loop(void)
 
 void board_uart0_init(void)
 {
-    ringbuffer_init(&uart0_ringbuffer, buffer, UART0_BUFSIZE);
+    tsrb_init(&uart0_ringbuffer, buffer, UART0_BUFSIZE);
     int pid = thread_create(
             uart0_thread_stack,
             sizeof(uart0_thread_stack),
@@ -42,7 +81,12 @@ void board_uart0_init(void)
 
 void uart0_handle_incoming(int c)
 {
-    rb_add_element(&uart0_ringbuffer, c);
+    tsrb_add_one(&uart0_ringbuffer, c);
+}
+
+int uart0_rx_free(void)
+{
+    return tsrb_free(&uart0_ringbuffer);
 }
 
 void uart0_notify_thread(void)
@@ -50,7 +94,29 @@ void uart0_notify_thread(void)
     msg_t m;
     m.type = 0;
     msg_send_int(&m, uart0_handler_pid);
+#ifdef MODULE_POSIX
+    fd_notify(&uart0_fd_ops, uart0_handler_pid);
+#endif
+}
+
+#ifdef MODULE_POSIX
+int uart0_fd_open(void)
+{
+    int fd;
+
+    if (posix_open(uart0_handler_pid, 0) < 0) {
+        return -1;
+    }
+
+    fd = fd_new(&uart0_fd_ops, uart0_handler_pid);
+
+    if (fd < 0) {
+        posix_close(uart0_handler_pid);
+    }
+
+    return fd;
 }
+#endif
 
 int uart0_readc(void)
 {
@@ -171,39 +171,21 @@ void vtimer_callback(void *ptr)
     update_shortterm();
 }
 
-void normalize_to_tick(timex_t *time)
-{
-    DEBUG("Normalizing: %" PRIu32 " %" PRIu32 "\n", time->seconds, time->microseconds);
-    uint32_t seconds_tmp = time->seconds % SECONDS_PER_TICK;
-    time->seconds -= seconds_tmp;
-    uint32_t usecs_tmp = time->microseconds + (seconds_tmp * 1000000);
-    DEBUG("Normalizin2: %" PRIu32 " %" PRIu32 "\n", time->seconds, usecs_tmp);
-
-    if (usecs_tmp < time->microseconds) {
-        usecs_tmp -= MICROSECONDS_PER_TICK;
-        time->seconds += SECONDS_PER_TICK;
-    }
-
-    if (usecs_tmp > MICROSECONDS_PER_TICK) {
-        usecs_tmp -= MICROSECONDS_PER_TICK;
-        time->seconds += SECONDS_PER_TICK;
-    }
-
-    time->microseconds = usecs_tmp;
-    DEBUG("     Result: %" PRIu32 " %" PRIu32 "\n", time->seconds, time->microseconds);
-}
-
 static int vtimer_set(vtimer_t *timer)
 {
     DEBUG("vtimer_set(): New timer. Offset: %" PRIu32 " %" PRIu32 "\n", timer->absolute.seconds, timer->absolute.microseconds);
 
-    timex_t now;
-    vtimer_now(&now);
-    timer->absolute = timex_add(now, timer->absolute);
-    normalize_to_tick(&(timer->absolute));
+    /* split the absolute time into the longterm tick it falls into and
+     * the offset within that tick */
+    timex64_t now = vtimer_now64();
+    timex64_t absolute = now + timex_to_64(timer->absolute);
+    uint32_t ticks = (uint32_t)(absolute / MICROSECONDS_PER_TICK);
+
+    timer->absolute.seconds = ticks * SECONDS_PER_TICK;
+    timer->absolute.microseconds = (uint32_t)(absolute - (timex64_t) ticks * MICROSECONDS_PER_TICK);
 
     DEBUG("vtimer_set(): Absolute: %" PRIu32 " %" PRIu32 "\n", timer->absolute.seconds, timer->absolute.microseconds);
-    DEBUG("vtimer_set(): NOW: %" PRIu32 " %" PRIu32 "\n", now.seconds, now.microseconds);
+    DEBUG("vtimer_set(): NOW: %" PRIu64 "\n", now);
 
     int result = 0;
 
@@ -246,6 +228,15 @@ void vtimer_now(timex_t *out)
     memcpy(out, &t, sizeof(timex_t));
 }
 
+timex64_t vtimer_now64(void)
+{
+    int state = disableIRQ();
+    timex64_t t = (timex64_t) seconds * TIMEX64_SECOND + (uint32_t)(hwtimer_now() - longterm_tick_start);
+    restoreIRQ(state);
+
+    return t;
+}
+
 int vtimer_init()
 {
     DEBUG("vtimer_init().\n");